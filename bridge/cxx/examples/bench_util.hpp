@@ -0,0 +1,76 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/* The common parts of the throughput benchmarks of the C++ bridge, which take the arguments:
+ *
+ *   <benchmark> [number of elements (2^24)] [number of repeats (10)]
+ */
+
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+#include <bhxx/bhxx.hpp>
+
+namespace bench {
+
+// The command line arguments of a benchmark
+struct Args {
+    uint64_t n;
+    size_t repeats;
+
+    Args(int argc, char *argv[]) : n(argc > 1 ? std::stoul(argv[1]) : (1ul << 24)),
+                                   repeats(argc > 2 ? std::stoul(argv[2]) : 10) {}
+};
+
+// Return a new contiguous array of `n` elements
+template<typename T>
+bhxx::BhArray<T> new_array(uint64_t n) {
+    const bhxx::Shape shape{n};
+    return bhxx::BhArray<T>(bhxx::make_base_ptr(T(0), n), shape, bhxx::contiguous_stride(shape));
+}
+
+// Time `func` and return the best time in seconds of `repeats` executions
+template<typename Func>
+double best_time(size_t repeats, Func func) {
+    // The first execution includes the compilation of the kernel
+    func();
+    bhxx::Runtime::instance().flush();
+
+    std::chrono::duration<double> best(0);
+    for (size_t i = 0; i < repeats; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        bhxx::Runtime::instance().flush();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 or elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best.count();
+}
+
+// Return the throughput in GB/s of moving `nbytes` in `seconds`
+inline double gbps(double nbytes, double seconds) {
+    return nbytes / seconds / 1e9;
+}
+
+} // bench
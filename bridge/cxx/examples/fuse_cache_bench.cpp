@@ -0,0 +1,98 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Micro-benchmark of the fuse cache lookup, which runs on every flush.
+ * It times cache hits of a synthetic instruction list of slices, reductions, and constants.
+ *
+ * Usage: fuse_cache_bench [number of instructions (1000)] [number of lookups (1000)]
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+
+#include <bohrium/bh_config_parser.hpp>
+#include <bohrium/bh_instruction.hpp>
+#include <bohrium/jitk/statistics.hpp>
+#include <bohrium/jitk/fuser_cache.hpp>
+
+using namespace std;
+using namespace bohrium;
+
+// Create `num_instrs` instructions that access `bases`
+vector<bh_instruction> create_instr_list(vector<unique_ptr<bh_base> > &bases, size_t num_instrs) {
+    const int64_t n = 1000;
+    vector<bh_instruction> ret;
+    for (size_t i = 0; i < num_instrs; ++i) {
+        bh_base *out = bases[i % bases.size()].get();
+        bh_base *in = bases[(i * 7 + 1) % bases.size()].get();
+        // A 2D slice that skips the first `i % 3` rows
+        bh_view out_view(out, static_cast<int64_t>(i % 3) * n, 2, {n - 2, n}, {n, 1});
+        bh_view in_view(in, static_cast<int64_t>(i % 5), 2, {n - 2, n}, {n, 1});
+        if (i % 10 == 9) { // Reduce the rows into a vector
+            bh_view vec(out, 0, 1, {n}, {1});
+            bh_instruction instr(BH_ADD_REDUCE, {vec, in_view, bh_view()});
+            instr.constant = bh_constant(int64_t{0});
+            ret.push_back(std::move(instr));
+        } else if (i % 2 == 0) {
+            ret.emplace_back(BH_ADD, vector<bh_view>{out_view, in_view, out_view});
+        } else {
+            bh_instruction instr(BH_MULTIPLY, {out_view, in_view, bh_view()});
+            instr.constant = bh_constant(static_cast<double>(i));
+            ret.push_back(std::move(instr));
+        }
+    }
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    const size_t num_instrs = argc > 1 ? stoul(argv[1]) : 1000;
+    const size_t num_lookups = argc > 2 ? stoul(argv[2]) : 1000;
+
+    vector<unique_ptr<bh_base> > bases;
+    for (int i = 0; i < 64; ++i) {
+        bases.emplace_back(new bh_base(1000 * 1000, bh_type::FLOAT64));
+    }
+    vector<bh_instruction> instrs = create_instr_list(bases, num_instrs);
+    vector<bh_instruction *> instr_list;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        instrs[i].origin_id = static_cast<int64_t>(i);
+        instr_list.push_back(&instrs[i]);
+    }
+
+    ConfigParser config(-1);
+    jitk::Statistics stat(false, config);
+    jitk::FuseCache fcache(stat, boost::filesystem::path(), true); // In-memory only
+    fcache.insert(instr_list, {}, 0);
+
+    const auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < num_lookups; ++i) {
+        if (not fcache.get(instr_list, 0).second) {
+            cerr << "Error: cache miss" << endl;
+            return 1;
+        }
+    }
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Fuse cache lookup of " << num_instrs << " instructions: " << elapsed.count() / num_lookups * 1e6
+         << " us (" << elapsed.count() / num_lookups / num_instrs * 1e9 << " ns per instruction)" << endl;
+    return 0;
+}
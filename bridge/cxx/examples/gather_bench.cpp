@@ -0,0 +1,74 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Benchmark of the gather and scatter of a large float64 array using a random and a sorted index, which reports
+ * the throughput in GB/s. Random indices make the gather and scatter latency-bound, thus compare the throughput
+ * with and without software prefetching using the environment variables e.g.:
+ *
+ *   BH_OPENMP_COMPILER_PREFETCH_DISTANCE=0 gather_bench
+ *   BH_OPENMP_COMPILER_PREFETCH_DISTANCE=16 gather_bench
+ *   BH_OPENMP_COMPILER_PREFETCH_DISTANCE=16 BH_OPENMP_COMPILER_SORTED_INDEX_CHECK=true gather_bench
+ *
+ * Usage: gather_bench [number of elements (2^24)] [number of repeats (10)]
+ */
+
+#include <string>
+#include <iostream>
+
+#include <bhxx/bhxx.hpp>
+
+#include "bench_util.hpp"
+
+using namespace std;
+using namespace bhxx;
+
+int main(int argc, char *argv[]) {
+    const bench::Args args(argc, argv);
+    const uint64_t n = args.n;
+
+    BhArray<uint64_t> sorted = bench::new_array<uint64_t>(n);
+    range(sorted);
+    // NB: multiplying by an odd number modulo a power of two is a permutation, which we use as the random index
+    const uint64_t multiplier = 2654435761u;
+    BhArray<uint64_t> random = bench::new_array<uint64_t>(n);
+    multiply(random, sorted, multiplier);
+    mod(random, random, n);
+    BhArray<double> in = bench::new_array<double>(n);
+    identity(in, sorted);
+    BhArray<double> out = bench::new_array<double>(n);
+    Runtime::instance().flush();
+
+    // NB: each element moves an index, a read, and a write
+    const double nbytes = n * (sizeof(uint64_t) + 2 * sizeof(double));
+    for (const auto &index: {make_pair(string("random"), &random), make_pair(string("sorted"), &sorted)}) {
+        const BhArray<uint64_t> &idx = *index.second;
+        const double tgather = bench::best_time(args.repeats, [&]() { gather(out, in, idx); });
+        // The gathered array of `in`, which holds 0, 1, 2, ..., is the index itself
+        if (n > 1 and out.vec()[1] != static_cast<double>(idx.vec()[1])) {
+            cerr << "Error: the gather of the " << index.first << " index is wrong" << endl;
+            return 1;
+        }
+        const double tscatter = bench::best_time(args.repeats, [&]() { scatter(out, in, idx); });
+        cout << "Gather and scatter of " << n << " float64 using a " << index.first << " index: "
+             << bench::gbps(nbytes, tgather) << " GB/s and " << bench::gbps(nbytes, tscatter) << " GB/s (best of "
+             << args.repeats << ")" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Benchmark of the add-reduction of a large float64 array, which reports the throughput in GB/s and the
+ * relative error of the sum. The reduction is a single loop-carried dependency unless the kernel uses multiple
+ * accumulators, thus compare the throughput of the configurations using the environment variables e.g.:
+ *
+ *   BH_OPENMP_COMPILER_EXPLICIT_SIMD=true BH_OPENMP_COMPILER_REDUCTION_ACCUMULATORS=1 reduce_bench
+ *   BH_OPENMP_COMPILER_EXPLICIT_SIMD=true BH_OPENMP_COMPILER_REDUCTION_ACCUMULATORS=4 reduce_bench
+ *   BH_OPENMP_COMPILER_EXPLICIT_SIMD=true BH_OPENMP_COMPILER_PAIRWISE_SUM=true reduce_bench
+ *
+ * Usage: reduce_bench [number of elements (2^24)] [number of repeats (10)]
+ */
+
+#include <cmath>
+#include <iostream>
+
+#include <bhxx/bhxx.hpp>
+
+#include "bench_util.hpp"
+
+using namespace std;
+using namespace bhxx;
+
+int main(int argc, char *argv[]) {
+    const bench::Args args(argc, argv);
+
+    // NB: the sum of a constant is known, which makes it possible to measure the rounding error
+    const double value = 0.1;
+    BhArray<double> a = bench::new_array<double>(args.n);
+    identity(a, value);
+    BhArray<double> r = bench::new_array<double>(1);
+    const double t = bench::best_time(args.repeats, [&]() { add_reduce(r, a, 0); });
+    const double sum = r.vec()[0];
+
+    const long double exact = static_cast<long double>(value) * args.n;
+    cout << "Add-reduce of " << args.n << " float64: " << bench::gbps(args.n * sizeof(double), t)
+         << " GB/s (best of " << args.repeats << "), relative error "
+         << static_cast<double>(fabsl((sum - exact) / exact)) << endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Benchmark of the add-accumulation (prefix sum) of a large int64 and float64 array, which reports the
+ * throughput in GB/s. The OpenMP backend writes the accumulation as a parallel scan when the accumulated axis is
+ * the only one, thus compare the throughput with the serial scan using the environment variables e.g.:
+ *
+ *   OMP_NUM_THREADS=8 BH_OPENMP_COMPILER_OPENMP_SCAN=true scan_bench
+ *   OMP_NUM_THREADS=8 BH_OPENMP_COMPILER_OPENMP_SCAN=false scan_bench
+ *
+ * Usage: scan_bench [number of elements (2^24)] [number of repeats (10)]
+ */
+
+#include <iostream>
+
+#include <bhxx/bhxx.hpp>
+
+#include "bench_util.hpp"
+
+using namespace std;
+using namespace bhxx;
+
+// Time the add-accumulation of `n` ones and check the last element of the prefix sum
+template<typename T>
+bool bench_scan(const string &name, const bench::Args &args) {
+    BhArray<T> a = bench::new_array<T>(args.n);
+    identity(a, T(1));
+    BhArray<T> r = bench::new_array<T>(args.n);
+    const double t = bench::best_time(args.repeats, [&]() { add_accumulate(r, a, 0); });
+
+    // NB: the accumulation reads and writes every element
+    cout << "Add-accumulate of " << args.n << " " << name << ": " << bench::gbps(2 * args.n * sizeof(T), t)
+         << " GB/s (best of " << args.repeats << ")" << endl;
+    // The prefix sum of ones is exact in float64 as long as `n` is below 2^53
+    if (r.vec().back() != static_cast<T>(args.n)) {
+        cerr << "Error: the last element of the " << name << " prefix sum is not " << args.n << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const bench::Args args(argc, argv);
+
+    if (not bench_scan<int64_t>("int64", args) or not bench_scan<double>("float64", args)) {
+        return 1;
+    }
+    return 0;
+}
@@ -82,16 +82,52 @@ int64_t bh_main_memory_unused() {
 
 
 namespace {
+// Function called with each new data region (see `bh_set_main_memory_hook()`)
+std::function<void(void *, uint64_t)> main_mem_hook;
+
+// Use transparent huge pages for data regions of at least `huge_page_size` bytes?
+bool main_mem_hugepage = false;
+constexpr uint64_t huge_page_size = 2 * 1024 * 1024;
+
 // Allocate page-size aligned main memory.
 void *main_mem_malloc(uint64_t nbytes) {
+#ifdef MADV_HUGEPAGE
+    const bool hugepage = main_mem_hugepage and nbytes >= huge_page_size;
+#else
+    const bool hugepage = false;
+#endif
+    // A huge page must be aligned thus we map an extra huge page and unmap the unaligned head and tail
+    const uint64_t map_nbytes = hugepage ? nbytes + huge_page_size : nbytes;
+
     // The MAP_PRIVATE and MAP_ANONYMOUS flags is not 100% portable. See:
     // <http://stackoverflow.com/questions/4779188/how-to-use-mmap-to-allocate-a-memory-in-heap>
-    void *ret = mmap(0, nbytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void *ret = mmap(0, map_nbytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
     if (ret == MAP_FAILED or ret == nullptr) {
         std::stringstream ss;
         ss << "main_mem_malloc() could not allocate a data region. Returned error code: " << strerror(errno);
         throw std::runtime_error(ss.str());
     }
+#ifdef MADV_HUGEPAGE
+    if (hugepage) {
+        const uint64_t page_size = MallocCache::GRANULARITY;
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(ret);
+        const uintptr_t end = begin + map_nbytes;
+        const uintptr_t aligned_begin = (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+        const uintptr_t aligned_end = aligned_begin + (nbytes + page_size - 1) / page_size * page_size;
+        if (aligned_begin > begin) {
+            munmap(ret, aligned_begin - begin);
+        }
+        if (end > aligned_end) {
+            munmap(reinterpret_cast<void *>(aligned_end), end - aligned_end);
+        }
+        ret = reinterpret_cast<void *>(aligned_begin);
+        // NB: this is only advice, which the OS ignores if transparent huge pages are disabled
+        madvise(ret, nbytes, MADV_HUGEPAGE);
+    }
+#endif
+    if (main_mem_hook) {
+        main_mem_hook(ret, nbytes);
+    }
     return ret;
 }
 
@@ -130,3 +166,14 @@ void bh_get_malloc_cache_stat(uint64_t &cache_lookup, uint64_t &cache_misses, ui
     max_memory_usage = malloc_cache.getMaxMemAllocated();
 }
 
+std::map<uint64_t, MallocCache::BinStat> bh_get_malloc_cache_bin_stat() {
+    return malloc_cache.getBinStats();
+}
+
+void bh_set_main_memory_hugepage(bool enable) {
+    main_mem_hugepage = enable;
+}
+
+void bh_set_main_memory_hook(std::function<void(void *mem, uint64_t nbytes)> hook) {
+    main_mem_hook = std::move(hook);
+}
@@ -19,6 +19,10 @@ If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <cassert>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <exception>
 
 #include <bohrium/jitk/apply_fusion.hpp>
 #include <bohrium/jitk/graph.hpp>
@@ -45,7 +49,8 @@ vector<Block> apply_pre_fusion(const FusionConfig &config, const vector<bh_instr
 
 // Apply the list of transformer specified by the names in 'transformer_names'
 // 'avoid_rank0_sweep' will avoid fusion of sweeped and non-sweeped blocks at the root level
-void apply_transformers(const FusionConfig &config, vector<Block> &block_list) {
+// 'num_loop_interchanges' is incremented by the number of blocks interchanged by `loop_interchange`
+void apply_transformers(const FusionConfig &config, vector<Block> &block_list, uint64_t &num_loop_interchanges) {
 
     for (auto it = config.fuser_list.begin(); it != config.fuser_list.end(); ++it) {
         if (*it == "push_reductions_inwards") {
@@ -54,6 +59,10 @@ void apply_transformers(const FusionConfig &config, vector<Block> &block_list) {
             split_for_threading(block_list);
         } else if (*it == "collapse_redundant_axes") {
             collapse_redundant_axes(block_list);
+        } else if (*it == "loop_interchange") {
+            num_loop_interchanges += loop_interchange(block_list);
+        } else if (*it == "tile") {
+            tile(block_list, config.tile_size);
         } else if (*it == "serial") {
             fuser_serial(block_list, config.avoid_rank0_sweep);
         } else if (*it == "breadth_first") {
@@ -62,6 +71,10 @@ void apply_transformers(const FusionConfig &config, vector<Block> &block_list) {
             fuser_reshapable_first(block_list, config.avoid_rank0_sweep);
         } else if (*it == "greedy") {
             fuser_greedy(config, block_list);
+        } else if (*it == "greedy_cost") {
+            fuser_greedy(config, block_list, &config.cost_model);
+        } else if (*it == "optimal") {
+            fuser_optimal(config, block_list);
         } else {
             cout << "Unknown transformer: \"" << *it << "\"" << endl;
             throw runtime_error("Unknown transformer!");
@@ -69,6 +82,90 @@ void apply_transformers(const FusionConfig &config, vector<Block> &block_list) {
     }
 }
 
+// Returns true when the transformers in 'fuser_list' never fuse blocks that aren't connected by a dependency,
+// thus fusing the independent components of a block list separately gives the same fusion
+bool fuses_along_dependencies(const vector<string> &fuser_list) {
+    const set<string> names = {"push_reductions_inwards", "split_for_threading", "collapse_redundant_axes",
+                               "greedy", "greedy_cost", "optimal", "loop_interchange", "tile"};
+    for (const string &name: fuser_list) {
+        if (names.find(name) == names.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Splits 'block_list' into components of blocks that share no arrays. The blocks keep their order within a
+// component and the components are ordered by their first block.
+vector<vector<Block> > independent_components(vector<Block> &block_list) {
+    // A union-find of the block indexes
+    vector<size_t> parent(block_list.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](size_t i) -> size_t {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    map<const bh_base *, size_t> base2block;
+    for (size_t i = 0; i < block_list.size(); ++i) {
+        set<const bh_base *> bases = block_list[i].getAllBases();
+        if (not block_list[i].isInstr()) {
+            const set<bh_base *> frees = block_list[i].getLoop().getAllFrees();
+            bases.insert(frees.begin(), frees.end());
+        }
+        for (const bh_base *base: bases) {
+            auto it = base2block.insert(make_pair(base, i));
+            if (not it.second) {
+                parent[root(i)] = root(it.first->second);
+            }
+        }
+    }
+    vector<vector<Block> > ret;
+    map<size_t, size_t> root2component;
+    for (size_t i = 0; i < block_list.size(); ++i) {
+        auto it = root2component.insert(make_pair(root(i), ret.size()));
+        if (it.second) {
+            ret.emplace_back();
+        }
+        ret[it.first->second].push_back(std::move(block_list[i]));
+    }
+    return ret;
+}
+
+// Apply the transformers to the independent components of 'block_list' in parallel using `config.pool`
+void apply_transformers_in_parallel(const FusionConfig &config, vector<Block> &block_list,
+                                    uint64_t &num_loop_interchanges) {
+    vector<vector<Block> > components = independent_components(block_list);
+    if (components.size() < 2) {
+        block_list = std::move(components[0]);
+        apply_transformers(config, block_list, num_loop_interchanges);
+        return;
+    }
+    vector<uint64_t> num_interchanges(components.size(), 0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    config.pool->parallelFor(components.size(), [&](uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i) {
+            try {
+                apply_transformers(config, components[i], num_interchanges[i]);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                error = std::current_exception();
+            }
+        }
+    });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    block_list.clear();
+    for (size_t i = 0; i < components.size(); ++i) {
+        std::move(components[i].begin(), components[i].end(), back_inserter(block_list));
+        num_loop_interchanges += num_interchanges[i];
+    }
+}
+
 // For better codegen cache utilization, we make sure that sweep instructions comes in a consisten order
 std::vector<InstrPtr> order_sweep_by_origin_id(const std::set<InstrPtr> &sweep_set) {
     vector<InstrPtr> ret;
@@ -102,7 +199,8 @@ void add_identity_block(LoopB &loop, int64_t &origin_count) {
             identity_instr.origin_id = origin_count++;
             identity_instr.constructor = sweep_instr->constructor;
             // We have to manually set the sweep axis of an accumulate output to 1. The backend will execute
-            // the for-loop in serial thus only the first element should be the identity.
+            // the for-loop in serial thus only the first element should be the identity. (A parallel scan,
+            // such as the one of the OpenMP backend, starts the chunk of each thread at the identity itself.)
             if (bh_opcode_is_accumulate(sweep_instr->opcode)) {
                 identity_instr.operand[0].shape[sweep_instr->sweep_axis()] = 1;
             }
@@ -147,7 +245,8 @@ vector<LoopB> add_identity_block(vector<Block> &block_list, int64_t &origin_coun
             identity_instr.origin_id = origin_count++;
             identity_instr.constructor = sweep_instr->constructor;
             // We have to manually set the sweep axis of an accumulate output to 1. The backend will execute
-            // the for-loop in serial thus only the first element should be the identity.
+            // the for-loop in serial thus only the first element should be the identity. (A parallel scan,
+            // such as the one of the OpenMP backend, starts the chunk of each thread at the identity itself.)
             if (bh_opcode_is_accumulate(sweep_instr->opcode)) {
                 identity_instr.operand[0].shape[sweep_instr->sweep_axis()] = 1;
             }
@@ -178,7 +277,7 @@ vector<Block> get_block_list(const vector<bh_instruction *> &instr_list, const F
                              Statistics &stat) {
     vector<Block> block_list;
     bool hit;
-    tie(block_list, hit) = fcache.get(instr_list);
+    tie(block_list, hit) = fcache.get(instr_list, config.settings_hash);
     if (not hit) {
         const auto tpre_fusion = chrono::steady_clock::now();
         stat.num_instrs_into_fuser += instr_list.size();
@@ -188,10 +287,15 @@ vector<Block> get_block_list(const vector<bh_instruction *> &instr_list, const F
         stat.num_blocks_out_of_fuser += block_list.size();
         const auto tfusion = chrono::steady_clock::now();
         stat.time_pre_fusion += tfusion - tpre_fusion;
-        // Then we fuse fully
-        apply_transformers(config, block_list);
+        // Then we fuse fully, which we can do in parallel when the transformers only fuse along dependencies
+        if (config.pool and block_list.size() >= config.parallel_threshold and
+            fuses_along_dependencies(config.fuser_list)) {
+            apply_transformers_in_parallel(config, block_list, stat.num_loop_interchanges);
+        } else {
+            apply_transformers(config, block_list, stat.num_loop_interchanges);
+        }
         stat.time_fusion += chrono::steady_clock::now() - tfusion;
-        fcache.insert(instr_list, block_list);
+        fcache.insert(instr_list, block_list, config.settings_hash);
     }
 
     // Pretty printing the block
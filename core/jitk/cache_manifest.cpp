@@ -0,0 +1,338 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <map>
+#include <set>
+#include <vector>
+#include <limits>
+#include <chrono>
+#include <cerrno>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <bohrium/jitk/cache_manifest.hpp>
+#include <bohrium/jitk/codegen_util.hpp>
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace bohrium {
+namespace jitk {
+
+namespace {
+
+constexpr uint64_t MANIFEST_MAGIC = 0x424f4852434d4631; // "BOHRCMF1"
+constexpr uint64_t MANIFEST_VERSION = 2;
+constexpr uint64_t MANIFEST_INITIAL_CAPACITY = 1024;
+// The number of files of a new manifest, which makes the first eviction scan the cache dir
+constexpr uint64_t MANIFEST_UNKNOWN_FILES = std::numeric_limits<uint64_t>::max();
+
+// Holds a `flock()` on `fd` while in scope
+class FileLock {
+private:
+    const int _fd;
+public:
+    FileLock(int fd, int operation) : _fd(fd) {
+        while (flock(_fd, operation) != 0 and errno == EINTR) {}
+    }
+
+    ~FileLock() {
+        flock(_fd, LOCK_UN);
+    }
+};
+
+// Return the current time in microseconds since epoch
+int64_t now() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+} // Anon namespace
+
+CacheManifest::CacheManifest(fs::path cache_dir, bool readonly) : _cache_dir(std::move(cache_dir)),
+                                                                   _readonly(readonly) {
+    const fs::path path = _cache_dir / "manifest.bin";
+    _fd = open(path.string().c_str(), readonly ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (_fd == -1) {
+        if (not readonly) {
+            cerr << "Warning: couldn't open the cache manifest " << path << ": " << strerror(errno) << endl;
+        }
+        return;
+    }
+    FileLock lock(_fd, readonly ? LOCK_SH : LOCK_EX);
+    if (not remap() and not readonly) {
+        initiate(MANIFEST_INITIAL_CAPACITY);
+    }
+}
+
+CacheManifest::~CacheManifest() {
+    if (_header != nullptr and not _uses.empty()) {
+        FileLock lock(_fd, LOCK_EX);
+        if (remap()) {
+            writeUses();
+        }
+    }
+    if (_header != nullptr) {
+        munmap(_header, _mapped_size);
+    }
+    if (_fd != -1) {
+        close(_fd);
+    }
+}
+
+bool CacheManifest::remap() {
+    struct stat st;
+    if (fstat(_fd, &st) != 0) {
+        return false;
+    }
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    if (_header != nullptr and file_size == _mapped_size) {
+        return true;
+    }
+    if (_header != nullptr) {
+        munmap(_header, _mapped_size);
+        _header = nullptr;
+        _mapped_size = 0;
+    }
+    if (file_size < sizeof(Header)) {
+        return false;
+    }
+    void *addr = mmap(nullptr, file_size, _readonly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, _fd, 0);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    _header = static_cast<Header *>(addr);
+    _mapped_size = file_size;
+    if (_header->magic != MANIFEST_MAGIC or _header->version != MANIFEST_VERSION or
+        sizeof(Header) + _header->capacity * sizeof(Entry) > _mapped_size or _header->count > _header->capacity) {
+        munmap(_header, _mapped_size);
+        _header = nullptr;
+        _mapped_size = 0;
+        return false;
+    }
+    _index_generation = _header->generation - 1; // Forces a reindex
+    return true;
+}
+
+bool CacheManifest::initiate(uint64_t capacity) {
+    assert(not _readonly);
+    if (_header != nullptr) {
+        munmap(_header, _mapped_size);
+        _header = nullptr;
+        _mapped_size = 0;
+    }
+    Header header;
+    header.magic = MANIFEST_MAGIC;
+    header.version = MANIFEST_VERSION;
+    header.count = 0;
+    header.capacity = capacity;
+    header.generation = 1;
+    header.files = MANIFEST_UNKNOWN_FILES;
+    if (ftruncate(_fd, 0) != 0 or ftruncate(_fd, sizeof(Header) + capacity * sizeof(Entry)) != 0 or
+        pwrite(_fd, &header, sizeof(header), 0) != sizeof(header)) {
+        cerr << "Warning: couldn't initiate the cache manifest in " << _cache_dir << endl;
+        return false;
+    }
+    return remap();
+}
+
+void CacheManifest::reindex() {
+    if (_index_generation == _header->generation) {
+        return;
+    }
+    _index.clear();
+    Entry *e = entries();
+    for (size_t i = 0; i < _header->count; ++i) {
+        _index[make_pair(e[i].compilation_hash, e[i].hash)] = i;
+    }
+    _index_generation = _header->generation;
+}
+
+void CacheManifest::writeUses() {
+    assert(not _readonly);
+    reindex();
+    Entry *e = entries();
+    for (const auto &use: _uses) {
+        auto it = _index.find(use.first);
+        if (it != _index.end()) {
+            e[it->second].last_use = std::max(e[it->second].last_use, use.second.first);
+            e[it->second].hits += use.second.second;
+        }
+    }
+    _uses.clear();
+}
+
+bool CacheManifest::lookup(uint64_t compilation_hash, uint64_t hash, uint64_t &library, string &symbol) {
+    if (_header == nullptr) {
+        return false;
+    }
+    // NB: a hit is only registered in `_uses`, thus a shared lock suffices
+    FileLock lock(_fd, LOCK_SH);
+    if (not remap()) {
+        return false;
+    }
+    reindex();
+    auto it = _index.find(make_pair(compilation_hash, hash));
+    if (it == _index.end()) {
+        return false;
+    }
+    const Entry &e = entries()[it->second];
+    library = e.library;
+    symbol = string(e.symbol, strnlen(e.symbol, sizeof(e.symbol)));
+    if (not _readonly) {
+        pair<int64_t, uint64_t> &use = _uses[it->first];
+        use.first = now();
+        ++use.second;
+    }
+    return true;
+}
+
+void CacheManifest::insert(uint64_t compilation_hash, uint64_t hash, uint64_t library, const string &symbol,
+                           uint64_t size) {
+    if (_header == nullptr or _readonly) {
+        return;
+    }
+    FileLock lock(_fd, LOCK_EX);
+    if (not remap() and not initiate(MANIFEST_INITIAL_CAPACITY)) {
+        return;
+    }
+    writeUses();
+
+    size_t idx;
+    auto it = _index.find(make_pair(compilation_hash, hash));
+    if (it != _index.end()) {
+        idx = it->second;
+    } else {
+        // Let's grow the file when full
+        if (_header->count == _header->capacity) {
+            const uint64_t capacity = _header->capacity * 2;
+            if (ftruncate(_fd, sizeof(Header) + capacity * sizeof(Entry)) != 0 or not remap()) {
+                cerr << "Warning: couldn't grow the cache manifest in " << _cache_dir << endl;
+                return;
+            }
+            _header->capacity = capacity;
+        }
+        idx = _header->count++;
+        ++_header->generation;
+        _index[make_pair(compilation_hash, hash)] = idx;
+        _index_generation = _header->generation;
+        entries()[idx].hits = 0;
+    }
+    Entry &e = entries()[idx];
+    e.hash = hash;
+    e.compilation_hash = compilation_hash;
+    e.library = library;
+    e.size = size;
+    e.last_use = now();
+    memset(e.symbol, 0, sizeof(e.symbol));
+    strncpy(e.symbol, symbol.c_str(), sizeof(e.symbol) - 1);
+}
+
+void CacheManifest::evict(uint64_t max_files, uint64_t new_files) {
+    if (_header == nullptr or _readonly) {
+        return;
+    }
+    FileLock lock(_fd, LOCK_EX);
+    if (not remap()) {
+        return;
+    }
+    writeUses();
+
+    // Let's avoid scanning the cache dir while it has room for the new files
+    if (_header->files != MANIFEST_UNKNOWN_FILES) {
+        _header->files += new_files;
+        if (_header->files <= max_files) {
+            return;
+        }
+    }
+
+    // Let's find the files of the cache dir and when they were last used
+    vector<pair<int64_t, fs::path> > files;
+    try {
+        // The most recent use of each library in the manifest
+        map<string, int64_t> library_uses;
+        Entry *e = entries();
+        for (size_t i = 0; i < _header->count; ++i) {
+            int64_t &last_use = library_uses[hash_filename(e[i].compilation_hash, e[i].library, ".so")];
+            last_use = std::max(last_use, e[i].last_use);
+        }
+        for (fs::directory_iterator it(_cache_dir), end; it != end; ++it) {
+            const fs::path &path = it->path();
+            if (path.filename() == "manifest.bin" or not fs::is_regular_file(path)) {
+                continue;
+            }
+            auto use = library_uses.find(path.filename().string());
+            if (use != library_uses.end()) {
+                files.push_back(make_pair(use->second, path));
+            } else {
+                files.push_back(make_pair(static_cast<int64_t>(fs::last_write_time(path)) * 1000000, path));
+            }
+        }
+    } catch (const fs::filesystem_error &e) {
+        cerr << "Warning: couldn't scan the cache dir " << _cache_dir << ": " << e.what() << endl;
+        return;
+    }
+    _header->files = files.size();
+    if (files.size() <= max_files) {
+        return;
+    }
+
+    // Let's remove the least recently used files
+    std::sort(files.begin(), files.end());
+    set<string> removed;
+    for (size_t i = 0; i < files.size() - max_files; ++i) {
+        boost::system::error_code ec; // We ignore errors such as already removed files
+        fs::remove(files[i].second, ec);
+        removed.insert(files[i].second.filename().string());
+    }
+    _header->files = max_files;
+
+    // And the kernels of the removed libraries
+    Entry *e = entries();
+    size_t count = 0;
+    for (size_t i = 0; i < _header->count; ++i) {
+        if (removed.find(hash_filename(e[i].compilation_hash, e[i].library, ".so")) == removed.end()) {
+            e[count++] = e[i];
+        }
+    }
+    if (count != _header->count) {
+        _header->count = count;
+        ++_header->generation;
+    }
+}
+
+uint64_t CacheManifest::size() {
+    if (_header == nullptr) {
+        return 0;
+    }
+    FileLock lock(_fd, LOCK_SH);
+    if (not remap()) {
+        return 0;
+    }
+    return _header->count;
+}
+
+} // jitk
+} // bohrium
@@ -53,6 +53,8 @@ void hash_stream(const bh_view &view, const SymbolTable &symbols, std::stringstr
         if (view.is_scalar()) { // We optimize indexes into 1-sized arrays, which we need the hash to reflect
             ss << "is-1-elem: " << endl;
         }
+    } else if (symbols.sizes_as_var and view.is_scalar()) { // Same as above since the shape isn't in the hash
+        ss << "is-1-elem: " << endl;
     }
 }
 
@@ -83,7 +85,11 @@ void hash_stream(const bh_instruction &instr, const SymbolTable &symbols, std::s
  */
 void hash_stream(const LoopB &block, const SymbolTable &symbols, std::stringstream &ss) {
     ss << "rank: " << block.rank;
-    ss << "size: " << block.size;
+    if (symbols.existLoopSizeID(block)) {
+        ss << "sizeid: " << symbols.loopSizeID(block);
+    } else {
+        ss << "size: " << block.size;
+    }
     {  // The order of BH_FREE within a block doesn't matter, thus we sort the freed base IDs here
         ss << "freed: ";
         set<uint64_t>sorted_freed_bases;
@@ -19,8 +19,13 @@ If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <sstream>
+#include <fstream>
+#include <iostream>
 #include <stdexcept>
+#include <dlfcn.h>
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
 #include <bohrium/jitk/compiler.hpp>
 #include <bohrium/jitk/subprocess.hpp>
 
@@ -40,8 +45,182 @@ string expand_compile_cmd(const string &cmd_template, const string &out, const s
 }
 
 
+namespace {
+// Load the libtcc function `name` from `handle`
+template<typename T>
+T load_tcc_function(void *handle, const char *name) {
+    dlerror(); // Reset errors
+    void *ret = dlsym(handle, name);
+    const char *dlsym_error = dlerror();
+    if (dlsym_error != nullptr) {
+        throw std::runtime_error(string("Cannot load libtcc function: ") + dlsym_error);
+    }
+    return reinterpret_cast<T>(ret);
+}
+
+// libtcc error callback, which appends the error message to the string `opaque`
+void tcc_error_callback(void *opaque, const char *msg) {
+    *static_cast<string *>(opaque) += string(msg) + "\n";
+}
+
+// Return the include paths (the "-I" options) of the command template
+vector<string> include_paths(const string &cmd_template) {
+    vector<string> ret;
+    vector<string> tokens;
+    boost::split(tokens, cmd_template, boost::is_any_of(" \t"), boost::token_compress_on);
+    for (const string &token: tokens) {
+        if (token.size() > 2 and token.compare(0, 2, "-I") == 0) {
+            ret.push_back(token.substr(2));
+        }
+    }
+    return ret;
+}
+} // Anon namespace
+
+InProcessCompiler::InProcessCompiler(const string &library, vector<string> include_paths) :
+        _include_paths(std::move(include_paths)) {
+    _lib_handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (_lib_handle == nullptr) {
+        throw std::runtime_error(string("Cannot load the in-process compiler: ") + dlerror());
+    }
+    _tcc_new = load_tcc_function<tcc_new_t>(_lib_handle, "tcc_new");
+    _tcc_delete = load_tcc_function<tcc_delete_t>(_lib_handle, "tcc_delete");
+    _tcc_set_output_type = load_tcc_function<tcc_set_output_type_t>(_lib_handle, "tcc_set_output_type");
+    _tcc_add_include_path = load_tcc_function<tcc_add_include_path_t>(_lib_handle, "tcc_add_include_path");
+    _tcc_set_error_func = load_tcc_function<tcc_set_error_func_t>(_lib_handle, "tcc_set_error_func");
+    _tcc_compile_string = load_tcc_function<tcc_compile_string_t>(_lib_handle, "tcc_compile_string");
+    _tcc_output_file = load_tcc_function<tcc_output_file_t>(_lib_handle, "tcc_output_file");
+    try {
+        findOutputDll();
+    } catch (...) {
+        dlclose(_lib_handle);
+        throw;
+    }
+}
+
+InProcessCompiler::~InProcessCompiler() {
+    for (auto &state: _states) {
+        if (state.second != nullptr) {
+            _tcc_delete(state.second);
+        }
+    }
+    if (_lib_handle != nullptr) {
+        dlclose(_lib_handle);
+    }
+}
+
+void InProcessCompiler::findOutputDll() {
+    // `TCC_OUTPUT_DLL` is 3 in libtcc 0.9.27 and 4 in later versions, where 3 means an object file. An object
+    // file cannot be loaded, thus the value that gives a loadable library is `TCC_OUTPUT_DLL`.
+    const boost::filesystem::path probe = boost::filesystem::temp_directory_path() /
+                                          boost::filesystem::unique_path("bh_libtcc_probe_%%%%-%%%%-%%%%.so");
+    string error;
+    for (int output_type: {3, 4}) {
+        void *state = newState(output_type);
+        if (state == nullptr) {
+            break;
+        }
+        _tcc_set_error_func(state, &error, tcc_error_callback);
+        const bool compiled = _tcc_compile_string(state, "int bh_libtcc_probe(void) { return 42; }") == 0 and
+                              _tcc_output_file(state, probe.string().c_str()) == 0;
+        _tcc_delete(state);
+        void *handle = compiled ? dlopen(probe.string().c_str(), RTLD_LAZY | RTLD_LOCAL) : nullptr;
+        boost::system::error_code ec;
+        boost::filesystem::remove(probe, ec);
+        if (handle != nullptr) {
+            dlclose(handle);
+            _output_dll = output_type;
+            // Since libtcc 0.9.28, compilation states are independent of each other
+            _reentrant = output_type != 3;
+            return;
+        }
+    }
+    throw std::runtime_error("The in-process compiler cannot create shared libraries: " + error);
+}
+
+void *InProcessCompiler::newState(int output_type) {
+    void *state = _tcc_new();
+    if (state == nullptr) {
+        return nullptr;
+    }
+    bool ret = _tcc_set_output_type(state, output_type) == 0;
+    for (const string &path: _include_paths) {
+        ret = ret and _tcc_add_include_path(state, path.c_str()) == 0;
+    }
+    if (not ret) {
+        _tcc_delete(state);
+        return nullptr;
+    }
+    return state;
+}
+
+void *InProcessCompiler::takeState(string &error) {
+    void *state = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_states_mutex);
+        auto it = _states.find(std::this_thread::get_id());
+        if (it != _states.end()) {
+            state = it->second;
+            it->second = nullptr;
+        }
+    }
+    if (state == nullptr) {
+        state = newState(_output_dll);
+    }
+    if (state == nullptr) {
+        error = "tcc_new() failed";
+        return nullptr;
+    }
+    _tcc_set_error_func(state, &error, tcc_error_callback);
+    return state;
+}
+
+void InProcessCompiler::prepareState() {
+    void *state = newState(_output_dll);
+    std::lock_guard<std::mutex> lock(_states_mutex);
+    void *&slot = _states[std::this_thread::get_id()];
+    if (slot != nullptr) {
+        _tcc_delete(slot);
+    }
+    slot = state;
+}
+
+bool InProcessCompiler::compile(const boost::filesystem::path &output_file, const string &source, string &error) {
+    std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+    if (not _reentrant) {
+        lock.lock();
+    }
+    void *state = takeState(error);
+    if (state == nullptr) {
+        return false;
+    }
+    const bool ret = _tcc_compile_string(state, source.c_str()) == 0 and
+                     _tcc_output_file(state, output_file.string().c_str()) == 0;
+    _tcc_delete(state);
+    prepareState();
+    return ret;
+}
+
+Compiler::Compiler(string cmd_template, string config_path, bool verbose, const string &backend,
+                   const string &library) : Compiler(std::move(cmd_template), std::move(config_path), verbose) {
+    if (backend == "libtcc") {
+        in_process = std::make_shared<InProcessCompiler>(library, include_paths(this->cmd_template));
+    } else if (backend != "subprocess") {
+        throw std::runtime_error("config: `compiler_backend` must be `subprocess` or `libtcc`");
+    }
+}
+
 void Compiler::compile(const boost::filesystem::path &output_file, const string &source,
                        const string &command) const {
+    if (inProcess(source, command)) {
+        string error;
+        if (in_process->compile(output_file, source, error)) {
+            return;
+        }
+        if (verbose) {
+            cout << "in-process compilation failed, falling back to the compile command:\n" << error << endl;
+        }
+    }
     const string cmd = expand_compile_cmd(command, output_file.string(), " - ", config_path);
     if (verbose) {
         cout << "compile command: \"" << cmd << "\"" << endl;
@@ -59,6 +238,20 @@ void Compiler::compile(const boost::filesystem::path &output_file, const string
 }
 
 void Compiler::compile(const boost::filesystem::path &output_file, const boost::filesystem::path &source_file, const std::string &command) const {
+    if (in_process and command == cmd_template) {
+        std::ifstream file(source_file.string());
+        stringstream source;
+        source << file.rdbuf();
+        if (inProcess(source.str(), command)) {
+            string error;
+            if (in_process->compile(output_file, source.str(), error)) {
+                return;
+            }
+            if (verbose) {
+                cout << "in-process compilation failed, falling back to the compile command:\n" << error << endl;
+            }
+        }
+    }
     const string cmd = expand_compile_cmd(command, output_file.string(), source_file.string(), config_path);
     if (verbose) {
         cout << "compile command: \"" << cmd << "\"" << endl;
@@ -0,0 +1,117 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <thread>
+
+#include <bohrium/jitk/cost_model.hpp>
+#include <bohrium/jitk/iterator.hpp>
+
+using namespace std;
+
+namespace bohrium {
+namespace jitk {
+
+CostModel::CostModel(const ConfigParser &config) :
+        _kernel_overhead(config.defaultGet<double>("cost_kernel_overhead", 5e-6)),
+        _bandwidth(config.defaultGet<double>("cost_bandwidth", 20e9)),
+        _thread_bandwidth(config.defaultGet<double>("cost_thread_bandwidth", 8e9)),
+        _compute_rate(config.defaultGet<double>("cost_compute_rate", 1e9)),
+        _num_threads(config.defaultGet<uint64_t>("cost_num_threads", 0) > 0 ?
+                     config.defaultGet<uint64_t>("cost_num_threads", 0) :
+                     max(1u, std::thread::hardware_concurrency())),
+        _num_registers(max<uint64_t>(1, config.defaultGet<uint64_t>("cost_num_registers", 16))),
+        _calibrate(config.defaultGet<bool>("cost_calibrate", false)) {
+    if (_bandwidth <= 0 or _thread_bandwidth <= 0 or _compute_rate <= 0) {
+        throw std::runtime_error("config: the bandwidths and compute rate of the cost model must be positive");
+    }
+}
+
+CostModel::Estimate CostModel::estimate(const LoopB &kernel) const {
+    Estimate ret;
+    const set<bh_base *> temps = kernel.getAllTemps();
+    for (const bh_base *base: kernel.getAllBases()) {
+        if (temps.find(const_cast<bh_base *>(base)) == temps.end()) {
+            ret.bytes += base->nbytes();
+        }
+        ++ret.num_arrays;
+    }
+    for (const InstrPtr &instr: iterator::allInstr(kernel)) {
+        if (not bh_opcode_is_system(instr->opcode)) {
+            ret.work += instr->operand[0].shape.prod();
+        }
+    }
+    ret.threading = parallel_ranks(kernel).second;
+    return ret;
+}
+
+CostModel::Estimate CostModel::estimate(const Block &block) const {
+    if (not block.isInstr()) {
+        return estimate(block.getLoop());
+    }
+    Estimate ret;
+    for (const bh_base *base: block.getAllBases()) {
+        ret.bytes += base->nbytes();
+        ++ret.num_arrays;
+    }
+    const bh_instruction &instr = *block.getInstr();
+    if (not bh_opcode_is_system(instr.opcode)) {
+        ret.work = instr.operand[0].shape.prod();
+    }
+    return ret;
+}
+
+double CostModel::_uncalibrated(const Estimate &estimate) const {
+    const double threads = static_cast<double>(min(max<uint64_t>(1, estimate.threading), _num_threads));
+    const double memory_time = estimate.bytes / min(_bandwidth, _thread_bandwidth * threads);
+    // Accessing more arrays than there are registers spills in the innermost loop
+    double spill = 1;
+    if (estimate.num_arrays > _num_registers) {
+        spill = estimate.num_arrays / static_cast<double>(_num_registers);
+    }
+    const double compute_time = estimate.work * spill / (_compute_rate * threads);
+    return max(memory_time, compute_time);
+}
+
+double CostModel::runtime(const Block &block) const {
+    if (block.isSystemOnly()) {
+        return 0; // System-only blocks are never launched
+    }
+    return _kernel_overhead + _uncalibrated(estimate(block)) * _scale.load(std::memory_order_relaxed);
+}
+
+bool CostModel::profitable(const Block &b1, const Block &b2, const Block &merged) const {
+    return runtime(merged) <= runtime(b1) + runtime(b2);
+}
+
+void CostModel::calibrate(const LoopB &kernel, std::chrono::duration<double> measured) const {
+    const double predicted = _uncalibrated(estimate(kernel));
+    if (predicted > 0) {
+        std::lock_guard<std::mutex> lock(_calibration_mutex);
+        _measured += max(0.0, measured.count() - _kernel_overhead);
+        _predicted += predicted;
+        if (_measured > 0) {
+            _scale.store(_measured / _predicted, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // jitk
+} // bohrium
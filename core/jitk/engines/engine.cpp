@@ -64,6 +64,10 @@ void Engine::writeKernelFunctionArguments(const jitk::SymbolTable &symbols,
         }
     }
 
+    for (const LoopB *loop: symbols.loopSizeBlocks()) {
+        stmp << writeType(bh_type::UINT64) << " vl" << symbols.loopSizeID(*loop) << ", ";
+    }
+
     if (not symbols.constIDs().empty()) {
         for (auto it = symbols.constIDs().begin(); it != symbols.constIDs().end(); ++it) {
             const InstrPtr &instr = *it;
@@ -222,6 +226,7 @@ void Engine::writeBlock(const SymbolTable &symbols,
             writeBlock(symbols, &scope, b.getLoop(), thread_stack, opencl, out);
             util::spaces(out, 4 + b.rank() * 4);
             out << "}\n";
+            loopTailWriter(symbols, scope, b.getLoop(), out);
         }
     }
 
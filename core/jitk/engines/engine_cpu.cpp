@@ -30,6 +30,8 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <bohrium/bh_component.hpp>
 #include <bohrium/bh_instruction.hpp>
 #include <bohrium/bh_main_memory.hpp>
+#include <bohrium/bh_util.hpp>
+#include <bohrium/jitk/iterator.hpp>
 
 using namespace std;
 
@@ -37,12 +39,43 @@ namespace bohrium {
 namespace jitk {
 
 void EngineCPU::handleExecution(BhIR *bhir) {
-
-    const auto texecution = chrono::steady_clock::now();
-
     // Some statistics
     stat.record(*bhir);
 
+    if (not lookahead) {
+        _handleExecution(bhir, false);
+        return;
+    }
+    // A repeated BhIR cannot defer instructions since each iteration must execute all of them. Deferred
+    // instructions are executed by the first flush after the deadline at the latest.
+    const auto now = chrono::steady_clock::now();
+    const bool allow_deferral = bhir->getNRepeats() == 1 and
+                                (_deferred.empty() or
+                                 now - _deferred_since < chrono::duration<double>(lookahead_deadline));
+    if (_deferred.empty()) {
+        _deferred_since = now;
+        _handleExecution(bhir, allow_deferral);
+    } else { // Let's fuse the deferred instructions with the instructions of `bhir`
+        vector<bh_instruction> instr_list = std::move(_deferred);
+        _deferred.clear();
+        instr_list.insert(instr_list.end(), bhir->instr_list.begin(), bhir->instr_list.end());
+        BhIR merged(std::move(instr_list), bhir->getSyncs());
+        _handleExecution(&merged, allow_deferral);
+    }
+}
+
+void EngineCPU::flushLookahead() {
+    if (not _deferred.empty()) {
+        BhIR bhir(std::move(_deferred), {});
+        _deferred.clear();
+        _handleExecution(&bhir, false);
+    }
+}
+
+void EngineCPU::_handleExecution(BhIR *bhir, bool allow_deferral) {
+
+    const auto texecution = chrono::steady_clock::now();
+
     // Let's start by cleanup the instructions from the 'bhir'
     set<bh_base *> frees;
     vector<bh_instruction *> instr_list = jitk::remove_non_computed_system_instr(bhir->instr_list, frees);
@@ -52,6 +85,57 @@ void EngineCPU::handleExecution(BhIR *bhir) {
         bh_data_free(base);
     }
 
+    // Let's find the instructions to defer, which must neither access sync'ed arrays (the host will read them) nor
+    // freed arrays (the bridge might delete them after this flush). Since the deferred instructions are executed
+    // after the rest of the instructions, a deferred instruction must also not depend on a later instruction that
+    // isn't deferred.
+    if (allow_deferral) {
+        const set<bh_base *> syncs = bhir->getSyncs();
+        set<bh_base *> freed(frees);
+        for (const bh_instruction *instr: instr_list) {
+            if (instr->opcode == BH_FREE) {
+                freed.insert(instr->operand[0].base);
+            }
+        }
+        // The arrays accessed and written by the later instructions that are executed
+        set<const bh_base *> executed_bases, executed_writes;
+        vector<bool> deferred(instr_list.size(), false);
+        for (size_t i = instr_list.size(); i-- > 0;) {
+            const bh_instruction &instr = *instr_list[i];
+            bool deferrable = not instr.operand.empty() and not bh_opcode_is_system(instr.opcode);
+            if (deferrable) {
+                for (const bh_base *base: iterator::allBases(instr)) {
+                    bh_base *b = const_cast<bh_base *>(base);
+                    if (util::exist(syncs, b) or util::exist(freed, b) or util::exist(executed_writes, base) or
+                        (base == instr.operand[0].base and util::exist(executed_bases, base))) {
+                        deferrable = false;
+                        break;
+                    }
+                }
+            }
+            if (deferrable) {
+                deferred[i] = true;
+            } else {
+                for (const bh_base *base: iterator::allBases(instr)) {
+                    executed_bases.insert(base);
+                }
+                if (not instr.operand.empty()) {
+                    executed_writes.insert(instr.operand[0].base);
+                }
+            }
+        }
+        vector<bh_instruction *> executed_instrs;
+        for (size_t i = 0; i < instr_list.size(); ++i) {
+            if (deferred[i]) {
+                _deferred.push_back(*instr_list[i]);
+            } else {
+                executed_instrs.push_back(instr_list[i]);
+            }
+        }
+        stat.num_deferred_instrs += instr_list.size() - executed_instrs.size();
+        instr_list = std::move(executed_instrs);
+    }
+
     // Set the constructor flag
     if (array_contraction) {
         setConstructorFlag(instr_list);
@@ -64,24 +148,26 @@ void EngineCPU::handleExecution(BhIR *bhir) {
     // Let's get the kernel list
     vector<LoopB> kernel_list = get_kernel_list(instr_list, fusion_config, fcache, stat);
 
-    for (const LoopB &kernel: kernel_list) {
-        // Let's create the symbol table for the kernel
-        const SymbolTable symbols(kernel,
-                                  use_volatile,
-                                  strides_as_var,
-                                  index_as_var,
-                                  const_as_var);
+    // Let's create the symbol table and find the source code of each kernel.
+    // NB: we reserve `symbol_list` since a `SymbolTable` refers to itself thus it must not be moved
+    vector<SymbolTable> symbol_list;
+    symbol_list.reserve(kernel_list.size());
+    vector<pair<string, uint64_t> > source_list(kernel_list.size()); // Pairs of source code and codegen hash
+    vector<pair<string, uint64_t> > new_sources; // Kernels not found in the codegen cache
+    vector<bool> codegen_hits(kernel_list.size(), false);
+    for (size_t i = 0; i < kernel_list.size(); ++i) {
+        const LoopB &kernel = kernel_list[i];
+        symbol_list.emplace_back(kernel,
+                                 use_volatile,
+                                 strides_as_var,
+                                 index_as_var,
+                                 const_as_var,
+                                 sizes_as_var);
+        const SymbolTable &symbols = symbol_list.back();
         stat.record(symbols);
 
         if (not kernel.isSystemOnly()) { // We can skip this step if the kernel does no computation
-            // Create the constant vector
-            vector<const bh_instruction *> constants;
-            constants.reserve(symbols.constIDs().size());
-            for (const InstrPtr &instr: symbols.constIDs()) {
-                constants.push_back(&(*instr));
-            }
-
-            const auto lookup = codegen_cache.lookup(kernel, symbols);
+            auto lookup = codegen_cache.lookup(kernel, symbols);
             if (not lookup.first.empty()) {
                 // In debug mode, we check that the cached source code is correct
                 #ifndef NDEBUG
@@ -93,16 +179,44 @@ void EngineCPU::handleExecution(BhIR *bhir) {
                         assert(1 == 2);
                     }
                 #endif
-                execute(symbols, lookup.first, lookup.second, constants);
+                source_list[i] = std::move(lookup);
+                codegen_hits[i] = true;
             } else {
                 const auto tcodegen = chrono::steady_clock::now();
                 stringstream ss;
                 writeKernel(kernel, symbols, {}, lookup.second, ss);
-                string source = ss.str();
+                source_list[i] = make_pair(ss.str(), lookup.second);
                 stat.time_codegen += chrono::steady_clock::now() - tcodegen;
 
-                execute(symbols, source, lookup.second, constants);
-                codegen_cache.insert(std::move(source), kernel, symbols);
+                new_sources.push_back(source_list[i]);
+                codegen_cache.insert(source_list[i].first, kernel, symbols);
+            }
+        }
+    }
+
+    // Let's compile all the new kernels at once before executing them one by one
+    if (not new_sources.empty()) {
+        compileAhead(new_sources);
+    }
+
+    for (size_t i = 0; i < kernel_list.size(); ++i) {
+        const LoopB &kernel = kernel_list[i];
+        if (not kernel.isSystemOnly()) {
+            // Create the constant vector
+            const SymbolTable &symbols = symbol_list[i];
+            vector<const bh_instruction *> constants;
+            constants.reserve(symbols.constIDs().size());
+            for (const InstrPtr &instr: symbols.constIDs()) {
+                constants.push_back(&(*instr));
+            }
+            // NB: we only calibrate the cost model using kernels found in the codegen cache since the execution of
+            //     new kernels might include their compilation
+            if (fusion_config.cost_model.calibrating() and codegen_hits[i]) {
+                const auto tkernel = chrono::steady_clock::now();
+                execute(kernel, symbols, source_list[i].first, source_list[i].second, constants);
+                fusion_config.cost_model.calibrate(kernel, chrono::steady_clock::now() - tkernel);
+            } else {
+                execute(kernel, symbols, source_list[i].first, source_list[i].second, constants);
             }
         }
 
@@ -124,6 +238,7 @@ void EngineCPU::handleExtmethod(BhIR *bhir){
             BhIR b(std::move(instr_list), bhir->getSyncs());
             comp.execute(&b);
             instr_list.clear(); // Notice, it is legal to clear a moved vector.
+            flushLookahead(); // The extension method might access arrays written by deferred instructions
             const auto texecution = std::chrono::steady_clock::now();
             ext->second.execute(&instr, nullptr); // Execute the extension method
             stat.time_ext_method += std::chrono::steady_clock::now() - texecution;
@@ -19,12 +19,14 @@ If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <fstream>
+#include <sstream>
 #include <numeric>
 #include <queue>
 #include <cassert>
 
 #include <bohrium/jitk/fuser.hpp>
 #include <bohrium/jitk/graph.hpp>
+#include <bohrium/jitk/transformer.hpp>
 #include <bohrium/bh_util.hpp>
 
 using namespace std;
@@ -32,6 +34,25 @@ using namespace std;
 namespace bohrium {
 namespace jitk {
 
+uint64_t fusion_settings_hash(const ConfigParser &config, bool avoid_rank0_sweep) {
+    // NB: we hash the raw values thus changing a setting to its default value also invalidates the cache.
+    //     The fuser threads are not included since they don't change the fusion result.
+    const char *keys[] = {"monolithic", "pre_fuser", "fuser_list", "greedy_threshold", "optimal_threshold",
+                          "optimal_max_nodes", "optimal_max_time", "tile_size", "cost_kernel_overhead",
+                          "cost_bandwidth", "cost_thread_bandwidth", "cost_compute_rate", "cost_num_threads",
+                          "cost_num_registers", "cost_calibrate"};
+    stringstream ss;
+    ss << avoid_rank0_sweep;
+    for (const char *key: keys) {
+        ss << ";" << key << "=" << config.defaultGet<string>(key, "");
+    }
+    // Without a tile size, the `tile` transformer derives it from the L1 cache size of this machine
+    if (config.defaultGet<uint64_t>("tile_size", 0) == 0) {
+        ss << ";l1_cache_size=" << l1_cache_size();
+    }
+    return util::hash(ss.str());
+}
+
 void simplify_instr(bh_instruction &instr) {
     if (instr.operand.empty()) {
         return;
@@ -370,7 +391,7 @@ void fuser_reshapable_first(vector<Block> &block_list, bool avoid_rank0_sweep) {
     block_list = ret;
 }
 
-void fuser_greedy(const FusionConfig &config, vector<Block> &block_list) {
+void fuser_greedy(const FusionConfig &config, vector<Block> &block_list, const CostModel *cost_model) {
 
     graph::DAG dag = graph::from_block_list(block_list);
 
@@ -379,10 +400,10 @@ void fuser_greedy(const FusionConfig &config, vector<Block> &block_list) {
         return;
     }
 
-    graph::greedy(dag, config.avoid_rank0_sweep);
+    graph::greedy(dag, config.avoid_rank0_sweep, cost_model);
     vector<Block> ret = graph::fill_block_list(dag);
 
-    // Let's fuse at the next rank level
+    // Let's fuse at the next rank level where the blocks are not kernels thus the cost model doesn't apply
     for (Block &b: ret) {
         if (not b.isInstr()) {
             fuser_greedy(config, b.getLoop()._block_list);
@@ -391,5 +412,23 @@ void fuser_greedy(const FusionConfig &config, vector<Block> &block_list) {
     block_list = ret;
 }
 
+void fuser_optimal(const FusionConfig &config, vector<Block> &block_list) {
+    if (block_list.size() > config.optimal_threshold) {
+        fuser_greedy(config, block_list);
+        return;
+    }
+    graph::DAG dag = graph::from_block_list(block_list);
+    graph::optimal(dag, config.avoid_rank0_sweep, config.optimal_max_nodes, config.optimal_max_time);
+    vector<Block> ret = graph::fill_block_list(dag);
+
+    // Let's fuse at the next rank level
+    for (Block &b: ret) {
+        if (not b.isInstr()) {
+            fuser_optimal(config, b.getLoop()._block_list);
+        }
+    }
+    block_list = ret;
+}
+
 } // jitk
 } // bohrium
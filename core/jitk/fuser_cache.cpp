@@ -19,56 +19,146 @@ If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <vector>
+#include <fstream>
+#include <ctime>
 #include <iostream>
+#include <unistd.h>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
 
 #include <bohrium/jitk/fuser_cache.hpp>
+#include <bohrium/jitk/codegen_util.hpp>
 
 
 using namespace std;
+namespace fs = boost::filesystem;
 
 namespace bohrium {
 namespace jitk {
 
 namespace {
 
-// Handling view IDs
+// A streaming hash of fixed-width 64-bit words, which uses the round and avalanche functions of xxHash64
+class Hasher {
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+    uint64_t _acc;
+
+    static uint64_t rotl(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+public:
+    explicit Hasher(uint64_t seed = 0) : _acc(seed + PRIME5) {}
+
+    // Add `word` to the hash
+    void add(uint64_t word) {
+        _acc ^= rotl(word * PRIME2, 31) * PRIME1;
+        _acc = rotl(_acc, 27) * PRIME1 + PRIME4;
+    }
+
+    // Returns the hash of the words added so far
+    uint64_t digest() const {
+        uint64_t h = _acc;
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+};
+
+// Handling view IDs using an open addressing hash table of the views in the instruction list
+// NB: the views are not copied thus they must outlive the ViewDB
 class ViewDB {
 private:
+    struct Entry {
+        const bh_view *view;
+        uint64_t hash;
+        size_t id;
+    };
     size_t maxid;
-    std::map<bh_view,size_t> _map;
+    // The table, which size is a power of two and an entry is unused when `view` is NULL
+    std::vector<Entry> _table;
+
+    static uint64_t hash(const bh_view &v) {
+        Hasher hasher;
+        hasher.add(reinterpret_cast<uint64_t>(v.base));
+        hasher.add(static_cast<uint64_t>(v.start));
+        hasher.add(static_cast<uint64_t>(v.ndim));
+        for (int64_t i = 0; i < v.ndim; ++i) {
+            hasher.add(static_cast<uint64_t>(v.shape[i]));
+            hasher.add(static_cast<uint64_t>(v.stride[i]));
+        }
+        return hasher.digest();
+    }
+
+    // Returns the entry of `v` or the unused entry where `v` belongs
+    Entry &find(const bh_view &v, uint64_t h) {
+        const size_t mask = _table.size() - 1;
+        for (size_t i = h & mask; ; i = (i + 1) & mask) {
+            Entry &e = _table[i];
+            if (e.view == nullptr or (e.hash == h and *e.view == v)) {
+                return e;
+            }
+        }
+    }
+
+    // Double the size of the table
+    void grow() {
+        std::vector<Entry> old(_table.size() * 2, Entry{nullptr, 0, 0});
+        old.swap(_table);
+        for (const Entry &e: old) {
+            if (e.view != nullptr) {
+                find(*e.view, e.hash) = e;
+            }
+        }
+    }
+
 public:
-    ViewDB() : maxid(0) {}
+    explicit ViewDB(size_t expected_size = 0) : maxid(0) {
+        size_t size = 16;
+        while (size < expected_size * 2) {
+            size *= 2;
+        }
+        _table.resize(size, Entry{nullptr, 0, 0});
+    }
 
     // Insert an object
     std::pair<size_t,bool> insert(const bh_view &v) {
-        auto it = _map.find(v);
-        if (it == _map.end()) {
-            size_t id = maxid++;
-            _map.insert(std::make_pair(v,id));
+        const uint64_t h = hash(v);
+        Entry &e = find(v, h);
+        if (e.view == nullptr) {
+            const size_t id = maxid++;
+            e = Entry{&v, h, id};
+            if (maxid * 2 > _table.size()) { // We keep the load factor below a half
+                grow();
+            }
             return std::make_pair(id,true);
-
         } else {
-            return  std::make_pair(it->second,false);
+            return std::make_pair(e.id,false);
         }
     }
 };
 
 
-constexpr size_t SEP_INSTR = SIZE_MAX;
-constexpr size_t SEP_OP = SIZE_MAX - 1;
-constexpr size_t SEP_SHAPE = SIZE_MAX - 2;
-constexpr size_t SEP_CONSTANT = SIZE_MAX - 3;
+constexpr uint64_t SEP_INSTR = UINT64_MAX;
+constexpr uint64_t SEP_CONSTANT = UINT64_MAX - 1;
 
-/* The Instruction hash consists of the following fields:
- * <view_id><start><ndim>[<shape><stride><SEP_SHAPE>...]<SEP_OP>
+/* The Instruction hash consists of the following fields, which all are 64-bit words:
+ * <view_id><start><ndim>[<shape><stride>...]
  */
-void hash_view(const bh_view &view, ViewDB &views, std::stringstream &ss) {
+void hash_view(const bh_view &view, ViewDB &views, Hasher &hasher) {
     if (not view.isConstant()) {
-        size_t view_id = views.insert(view).first;
-        ss << view_id;
+        hasher.add(views.insert(view).first);
         // Sliding views has identical hashes across iterations
         if (not view.hasSlide()) {
-            ss << view.start;
+            hasher.add(static_cast<uint64_t>(view.start));
         } else {
             // Check whether the shape of the sliding view is a single value
             bool single_index = true;
@@ -79,43 +169,41 @@ void hash_view(const bh_view &view, ViewDB &views, std::stringstream &ss) {
                 }
             }
             if (!single_index) {
-                ss << view.start;
+                hasher.add(static_cast<uint64_t>(view.start));
             }
         }
 
-        ss << view.ndim;
+        hasher.add(static_cast<uint64_t>(view.ndim));
         for (int j = 0; j < view.ndim; ++j) {
-            ss << view.shape[j];
-            ss << view.stride[j];
-            ss << SEP_SHAPE;
+            hasher.add(static_cast<uint64_t>(view.shape[j]));
+            hasher.add(static_cast<uint64_t>(view.stride[j]));
         }
-        ss << SEP_OP;
     } else {
         // Notice, we can ignore the value of the constant but we need to hash the location of the constant
-        ss << SEP_CONSTANT;
+        hasher.add(SEP_CONSTANT);
     }
 }
 
 /* The Instruction hash consists of the following fields:
- * <opcode[<hash_view>...]<sweep_axis()><SEP_INSTR>
+ * <opcode>[<hash_view>...]<sweep_axis()><SEP_INSTR>
  */
-void hash_instr(const bh_instruction &instr, ViewDB &views, std::stringstream &ss) {
-    ss << instr.opcode; // <opcode>
+void hash_instr(const bh_instruction &instr, ViewDB &views, Hasher &hasher) {
+    hasher.add(static_cast<uint64_t>(instr.opcode));
     for(const bh_view &op: instr.operand) {
-        hash_view(op, views, ss);
+        hash_view(op, views, hasher);
     }
-    ss << instr.sweep_axis();
-    ss << SEP_INSTR;
+    hasher.add(static_cast<uint64_t>(instr.sweep_axis()));
+    hasher.add(SEP_INSTR);
 }
 
 // Hash of an instruction list
 size_t hash_instr_list(const vector<bh_instruction *> &instr_list) {
-    stringstream ss;
-    ViewDB views;
+    Hasher hasher;
+    ViewDB views(instr_list.size() * 2);
     for (const bh_instruction *instr: instr_list) {
-        hash_instr(*instr, views, ss);
+        hash_instr(*instr, views, hasher);
     }
-    return util::hash(ss.str());
+    return hasher.digest();
 }
 
 // Replace the cached values of constants and bases arrays in `instr` with their original values
@@ -177,13 +265,189 @@ std::vector<bh_base*> calc_base_ids(const vector<bh_instruction *> &instr_list)
     }
     return ret;
 }
+
+constexpr uint64_t FUSE_FILE_MAGIC = 0x424f485246555345; // "BOHRFUSE"
+constexpr uint64_t FUSE_FILE_VERSION = 1;
+
+/* On disk, a block list is written in terms of positions thus it doesn't depend on the process that wrote it:
+ *   - an instruction keeps its `origin_id`, which is its position in the instruction list
+ *   - a base array is written as its position in `calc_base_ids()` plus one (zero is a constant)
+ * When loading, the bases are the positions cast to pointers, which `update_with_origin()` replaces
+ * with the new bases just like cached bases from an earlier flush.
+ */
+void save_block(boost::archive::binary_oarchive &ar, const Block &block, const map<bh_base*, size_t> &base2id) {
+    const bool is_instr = block.isInstr();
+    ar << is_instr;
+    if (is_instr) {
+        bh_instruction instr(*block.getInstr());
+        for (bh_view &view: instr.getViews()) {
+            view.base = reinterpret_cast<bh_base*>(base2id.at(view.base) + 1);
+        }
+        const int rank = block.rank();
+        ar << rank;
+        ar << instr;
+        ar << instr.constructor;
+        ar << instr.origin_id;
+    } else {
+        const LoopB &loop = block.getLoop();
+        ar << loop.rank;
+        ar << loop.size;
+        vector<size_t> frees;
+        for (bh_base *base: loop._frees) {
+            frees.push_back(base2id.at(base) + 1);
+        }
+        ar << frees;
+        const size_t num_blocks = loop._block_list.size();
+        ar << num_blocks;
+        for (const Block &b: loop._block_list) {
+            save_block(ar, b, base2id);
+        }
+    }
+}
+
+// Load a block written by `save_block()`. Throws std::runtime_error if the block doesn't match 'instr_list'
+Block load_block(boost::archive::binary_iarchive &ar, const vector<bh_instruction *> &instr_list,
+                 size_t num_bases) {
+    bool is_instr;
+    ar >> is_instr;
+    if (is_instr) {
+        int rank;
+        bh_instruction instr;
+        ar >> rank;
+        ar >> instr;
+        ar >> instr.constructor;
+        ar >> instr.origin_id;
+        if (instr.origin_id < 0 or static_cast<size_t>(instr.origin_id) >= instr_list.size() or
+            instr_list[instr.origin_id]->opcode != instr.opcode or
+            instr_list[instr.origin_id]->operand.size() != instr.operand.size()) {
+            throw runtime_error("the instructions doesn't match");
+        }
+        for (const bh_view &view: instr.getViews()) {
+            if (reinterpret_cast<size_t>(view.base) > num_bases) {
+                throw runtime_error("the bases doesn't match");
+            }
+        }
+        return Block(instr, rank);
+    } else {
+        LoopB loop;
+        ar >> loop.rank;
+        ar >> loop.size;
+        vector<size_t> frees;
+        ar >> frees;
+        for (size_t id: frees) {
+            if (id == 0 or id > num_bases) {
+                throw runtime_error("the bases doesn't match");
+            }
+            loop._frees.insert(reinterpret_cast<bh_base*>(id));
+        }
+        size_t num_blocks;
+        ar >> num_blocks;
+        for (size_t i = 0; i < num_blocks; ++i) {
+            loop._block_list.push_back(load_block(ar, instr_list, num_bases));
+        }
+        return Block(std::move(loop));
+    }
+}
 } // Anon namespace
 
-pair<vector<Block>, bool> FuseCache::get(const vector<bh_instruction *> &instr_list) {
+fs::path FuseCache::_filePath(size_t lookup_hash, uint64_t settings_hash) const {
+    return _cache_dir / hash_filename(settings_hash, lookup_hash, ".fuse");
+}
+
+bool FuseCache::_load(const vector<bh_instruction *> &instr_list, size_t lookup_hash, uint64_t settings_hash) {
+    if (_cache_dir.empty()) {
+        return false;
+    }
+    std::ifstream file(_filePath(lookup_hash, settings_hash).string(), ios::binary);
+    if (not file.is_open()) {
+        return false;
+    }
+    const size_t num_bases = calc_base_ids(instr_list).size();
+    CachePayload payload;
+    try {
+        boost::archive::binary_iarchive ar(file);
+        uint64_t magic, version;
+        size_t num_instrs, num_cached_bases, num_blocks;
+        ar >> magic >> version >> num_instrs >> num_cached_bases >> num_blocks;
+        // Let's make sure that the file was written by this version and that it matches the instruction list
+        if (magic != FUSE_FILE_MAGIC or version != FUSE_FILE_VERSION or num_instrs != instr_list.size() or
+            num_cached_bases != num_bases) {
+            return false;
+        }
+        for (size_t i = 0; i < num_blocks; ++i) {
+            payload.block_list.push_back(load_block(ar, instr_list, num_bases));
+        }
+    } catch (const std::exception &e) { // Includes `boost::archive::archive_exception`
+        if (stat.verbose) {
+            cerr << "Warning: ignoring the fuse cache file " << _filePath(lookup_hash, settings_hash) << ": "
+                 << e.what() << endl;
+        }
+        return false;
+    }
+    for (size_t id = 1; id <= num_bases; ++id) {
+        payload.base_ids.push_back(reinterpret_cast<bh_base*>(id));
+    }
+    _cache.insert(make_pair(lookup_hash, std::move(payload)));
+    // The eviction of the cache dir removes the least recently modified fuse files, thus we touch the file
+    if (not _readonly) {
+        boost::system::error_code ec;
+        fs::last_write_time(_filePath(lookup_hash, settings_hash), std::time(nullptr), ec);
+    }
+    return true;
+}
+
+void FuseCache::_store(const CachePayload &payload, size_t num_instrs, size_t lookup_hash,
+                       uint64_t settings_hash) {
+    if (_readonly or _cache_dir.empty()) {
+        return;
+    }
+    map<bh_base*, size_t> base2id;
+    for (size_t i = 0; i < payload.base_ids.size(); ++i) {
+        base2id[payload.base_ids[i]] = i;
+    }
+    // We write to a temporary file and rename it, which is atomic when other processes share the cache dir
+    const fs::path path = _filePath(lookup_hash, settings_hash);
+    fs::path tmp_path = path;
+    tmp_path += "." + to_string(getpid()) + ".tmp";
+    try {
+        {
+            std::ofstream file(tmp_path.string(), ios::binary);
+            if (not file.is_open()) {
+                return;
+            }
+            boost::archive::binary_oarchive ar(file);
+            const size_t num_bases = payload.base_ids.size();
+            const size_t num_blocks = payload.block_list.size();
+            const uint64_t magic = FUSE_FILE_MAGIC, version = FUSE_FILE_VERSION;
+            ar << magic << version << num_instrs << num_bases << num_blocks;
+            for (const Block &block: payload.block_list) {
+                save_block(ar, block, base2id);
+            }
+        }
+        const bool exists = fs::exists(path);
+        fs::rename(tmp_path, path);
+        if (not exists) {
+            ++_num_new_files;
+        }
+    } catch (const std::exception &e) {
+        boost::system::error_code ec;
+        fs::remove(tmp_path, ec);
+        if (stat.verbose) {
+            cerr << "Warning: couldn't write the fuse cache file " << path << ": " << e.what() << endl;
+        }
+    }
+}
+
+pair<vector<Block>, bool> FuseCache::get(const vector<bh_instruction *> &instr_list, uint64_t settings_hash) {
     const size_t lookup_hash = hash_instr_list(instr_list);
     ++stat.fuser_cache_lookups;
 
-    if (_cache.find(lookup_hash) != _cache.end()) { // Cache hit!
+    bool hit = _cache.find(lookup_hash) != _cache.end();
+    if (not hit and _load(instr_list, lookup_hash, settings_hash)) {
+        ++stat.fuser_cache_disk_hits;
+        hit = true;
+    }
+    if (hit) { // Cache hit!
         // Create a map: 'origin_id' => instruction for updating the constants
         map<int64_t, const bh_instruction *> origin_id_to_instr;
         for(const bh_instruction *instr: instr_list) {
@@ -213,9 +477,11 @@ pair<vector<Block>, bool> FuseCache::get(const vector<bh_instruction *> &instr_l
     }
 }
 
-void FuseCache::insert(const vector<bh_instruction *> &instr_list, vector<Block> block_list) {
+void FuseCache::insert(const vector<bh_instruction *> &instr_list, vector<Block> block_list,
+                       uint64_t settings_hash) {
     const size_t lookup_hash = hash_instr_list(instr_list);
     CachePayload payload = {std::move(block_list), calc_base_ids(instr_list)};
+    _store(payload, instr_list.size(), lookup_hash, settings_hash);
     _cache.insert(make_pair(lookup_hash, std::move(payload)));
 }
 
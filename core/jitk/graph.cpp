@@ -26,9 +26,13 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <boost/foreach.hpp>
 #include <fstream>
 #include <numeric>
+#include <algorithm>
 #include <queue>
 #include <cassert>
+#include <chrono>
+#include <functional>
 
+#include <bohrium/bh_util.hpp>
 #include <bohrium/jitk/graph.hpp>
 #include <bohrium/jitk/block.hpp>
 #include <bohrium/jitk/iterator.hpp>
@@ -316,52 +320,566 @@ void pprint(const DAG &dag, const char *filename, bool avoid_rank0_sweep, int id
     file.close();
 }
 
-void greedy(DAG &dag, bool avoid_rank0_sweep) {
-    while(1) {
-        // First we find all fusible edges
-        vector<Edge> fusibles;
-        {
-            auto edges = boost::edges(dag);
-            for (auto it = edges.first; it != edges.second;) {
-                Edge e = *it; ++it; // NB: we iterate here because boost::remove_edge() invalidates 'it'
-                Vertex v1 = source(e, dag);
-                Vertex v2 = target(e, dag);
-                // Remove transitive edges
-                if(path_exist(v1, v2, dag, true)) {
-                    boost::remove_edge(e, dag);
+namespace {
+
+/* Maintains a topological order of the vertices of a DAG while edges are added, which makes it possible to
+ * bound path searches to the vertices ordered between the source and the target.
+ *
+ * When an edge violates the order, only the affected vertices are reordered using the algorithm by Pearce and
+ * Kelly: "A Dynamic Topological Sort Algorithm for Directed Acyclic Graphs" (2006).
+ */
+class TopologicalOrder {
+    const DAG &_dag;
+    // The position of each vertex in the order
+    vector<uint64_t> _ord;
+    // Visit marks of the searches, which are reset by incrementing `_epoch`
+    vector<uint64_t> _mark;
+    uint64_t _epoch = 0;
+
+    // Append the vertices reachable from 'v' that are ordered before 'upper_bound' to 'out'
+    void _forward(Vertex v, uint64_t upper_bound, vector<Vertex> &out) {
+        vector<Vertex> stack{v};
+        _mark[v] = _epoch;
+        while (not stack.empty()) {
+            const Vertex w = stack.back();
+            stack.pop_back();
+            out.push_back(w);
+            BOOST_FOREACH(Vertex child, boost::adjacent_vertices(w, _dag)) {
+                if (_mark[child] != _epoch and _ord[child] < upper_bound) {
+                    _mark[child] = _epoch;
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+
+    // Append the vertices that reach 'v' and are ordered at or after 'lower_bound' to 'out'
+    void _backward(Vertex v, uint64_t lower_bound, vector<Vertex> &out) {
+        vector<Vertex> stack{v};
+        _mark[v] = _epoch;
+        while (not stack.empty()) {
+            const Vertex w = stack.back();
+            stack.pop_back();
+            out.push_back(w);
+            BOOST_FOREACH(Vertex parent, boost::inv_adjacent_vertices(w, _dag)) {
+                if (_mark[parent] != _epoch and _ord[parent] >= lower_bound) {
+                    _mark[parent] = _epoch;
+                    stack.push_back(parent);
+                }
+            }
+        }
+    }
+
+public:
+    explicit TopologicalOrder(const DAG &dag) : _dag(dag), _ord(boost::num_vertices(dag)),
+                                                _mark(boost::num_vertices(dag), 0) {
+        vector<Vertex> topological_order;
+        boost::topological_sort(dag, back_inserter(topological_order));
+        uint64_t i = 0;
+        BOOST_REVERSE_FOREACH(const Vertex &v, topological_order) {
+            _ord[v] = i++;
+        }
+    }
+
+    // Returns all vertices in topological order
+    vector<Vertex> vertices() const {
+        vector<Vertex> ret(_ord.size());
+        for (Vertex v = 0; v < _ord.size(); ++v) {
+            ret[_ord[v]] = v;
+        }
+        return ret;
+    }
+
+    // Repair the order after the edge 'src' -> 'dst' has been added to the DAG
+    void edgeAdded(Vertex src, Vertex dst) {
+        if (_ord[src] < _ord[dst]) {
+            return; // The order is still valid
+        }
+        ++_epoch;
+        vector<Vertex> forward_set, backward_set;
+        _forward(dst, _ord[src], forward_set);
+        _backward(src, _ord[dst] + 1, backward_set);
+        assert(find(forward_set.begin(), forward_set.end(), src) == forward_set.end()); // The DAG has a cycle
+
+        // The vertices that reach 'src' take the first of the affected positions followed by the
+        // vertices reachable from 'dst'
+        const auto by_order = [this](Vertex a, Vertex b) -> bool { return _ord[a] < _ord[b]; };
+        sort(forward_set.begin(), forward_set.end(), by_order);
+        sort(backward_set.begin(), backward_set.end(), by_order);
+        vector<uint64_t> positions;
+        positions.reserve(forward_set.size() + backward_set.size());
+        for (Vertex v: backward_set) {
+            positions.push_back(_ord[v]);
+        }
+        for (Vertex v: forward_set) {
+            positions.push_back(_ord[v]);
+        }
+        sort(positions.begin(), positions.end());
+        uint64_t i = 0;
+        for (Vertex v: backward_set) {
+            _ord[v] = positions[i++];
+        }
+        for (Vertex v: forward_set) {
+            _ord[v] = positions[i++];
+        }
+    }
+
+    // Returns the children of 'v' that are also reachable through a longer path, i.e. the transitive out-edges
+    // NB: a child can only be reached through the children ordered before it
+    vector<Vertex> transitiveChildren(Vertex v) {
+        vector<Vertex> children;
+        BOOST_FOREACH(Vertex child, boost::adjacent_vertices(v, _dag)) {
+            children.push_back(child);
+        }
+        sort(children.begin(), children.end(), [this](Vertex a, Vertex b) -> bool { return _ord[a] < _ord[b]; });
+        ++_epoch;
+        vector<Vertex> ret, reachable;
+        for (Vertex child: children) {
+            if (_mark[child] == _epoch) {
+                ret.push_back(child);
+            } else {
+                _forward(child, _ord[children.back()] + 1, reachable);
+            }
+        }
+        return ret;
+    }
+
+    // Returns the parents of 'v' that also reach 'v' through a longer path, i.e. the transitive in-edges
+    vector<Vertex> transitiveParents(Vertex v) {
+        vector<Vertex> parents;
+        BOOST_FOREACH(Vertex parent, boost::inv_adjacent_vertices(v, _dag)) {
+            parents.push_back(parent);
+        }
+        sort(parents.begin(), parents.end(), [this](Vertex a, Vertex b) -> bool { return _ord[a] > _ord[b]; });
+        ++_epoch;
+        vector<Vertex> ret, reaching;
+        for (Vertex parent: parents) {
+            if (_mark[parent] == _epoch) {
+                ret.push_back(parent);
+            } else {
+                _backward(parent, _ord[parents.back()], reaching);
+            }
+        }
+        return ret;
+    }
+
+    // Determines whether there exist a path of length greater than one from 'a' to 'b'
+    // NB: only the vertices ordered between 'a' and 'b' are visited
+    bool longPathExist(Vertex a, Vertex b) {
+        ++_epoch;
+        vector<Vertex> stack;
+        BOOST_FOREACH(Vertex child, boost::adjacent_vertices(a, _dag)) {
+            if (child != b and _ord[child] < _ord[b]) {
+                _mark[child] = _epoch;
+                stack.push_back(child);
+            }
+        }
+        while (not stack.empty()) {
+            const Vertex w = stack.back();
+            stack.pop_back();
+            BOOST_FOREACH(Vertex child, boost::adjacent_vertices(w, _dag)) {
+                if (child == b) {
+                    return true;
+                }
+                if (_mark[child] != _epoch and _ord[child] < _ord[b]) {
+                    _mark[child] = _epoch;
+                    stack.push_back(child);
+                }
+            }
+        }
+        return false;
+    }
+};
+
+// A fusible edge in the priority queue of the greedy fuser
+struct Candidate {
+    uint64_t weight;
+    Vertex src, dst;
+    // The versions of 'src' and 'dst' when the candidate was created
+    uint64_t src_version, dst_version;
+
+    // The greatest weight first and on ties, the lowest vertex IDs first
+    bool operator<(const Candidate &other) const {
+        if (weight != other.weight) {
+            return weight < other.weight;
+        }
+        return make_pair(src, dst) > make_pair(other.src, other.dst);
+    }
+};
+
+// Remove the vertices in 'dag' marked in 'removed', which must have no edges
+// NB: removing them one by one using `boost::remove_vertex()` would cost O(V) each
+void remove_vertices(DAG &dag, const vector<bool> &removed) {
+    DAG compact;
+    vector<Vertex> new_vertex(boost::num_vertices(dag));
+    BOOST_FOREACH(Vertex v, boost::vertices(dag)) {
+        if (not removed[v]) {
+            new_vertex[v] = boost::add_vertex(dag[v], compact);
+        }
+    }
+    BOOST_FOREACH(Edge e, boost::edges(dag)) {
+        assert(not removed[source(e, dag)] and not removed[target(e, dag)]);
+        boost::add_edge(new_vertex[source(e, dag)], new_vertex[target(e, dag)], compact);
+    }
+    dag = std::move(compact);
+}
+}
+
+void greedy(DAG &dag, bool avoid_rank0_sweep, const CostModel *cost_model) {
+    const uint64_t num_vertices = boost::num_vertices(dag);
+    TopologicalOrder order(dag);
+
+    // The news and frees of each vertex, which `weight()` would otherwise compute for every edge
+    vector<set<bh_base *> > news(num_vertices), frees(num_vertices);
+    // The version of each vertex, which is incremented when the vertex changes
+    vector<uint64_t> version(num_vertices, 0);
+    // The vertices merged into another vertex
+    vector<bool> merged(num_vertices, false);
+
+    auto update_vertex = [&](Vertex v) {
+        if (not dag[v].isInstr()) {
+            news[v] = dag[v].getLoop().getAllNews();
+            frees[v] = dag[v].getLoop().getAllFrees();
+        }
+    };
+    priority_queue<Candidate> candidates;
+    auto push_candidate = [&](Vertex src, Vertex dst) {
+        if (mergeable(dag[src], dag[dst], avoid_rank0_sweep)) {
+            uint64_t totalsize = 0;
+            const set<bh_base *> &n = news[src], &f = frees[dst];
+            for (auto it = n.begin(), jt = f.begin(); it != n.end() and jt != f.end();) {
+                if (*it < *jt) {
+                    ++it;
+                } else if (*jt < *it) {
+                    ++jt;
                 } else {
-                    const Block &b1 = dag[v1];
-                    const Block &b2 = dag[v2];
-                    if (mergeable(b1, b2, avoid_rank0_sweep)) {
-                        fusibles.push_back(e);
-                    }
+                    totalsize += (*it)->nbytes();
+                    ++it;
+                    ++jt;
                 }
             }
+            candidates.push(Candidate{totalsize, src, dst, version[src], version[dst]});
+        }
+    };
+
+    // Remove the transitive out-edges of 'v' (and in-edges if 'parents') and push the rest as candidates
+    auto update_edges = [&](Vertex v, bool parents) {
+        for (Vertex child: order.transitiveChildren(v)) {
+            boost::remove_edge(v, child, dag);
+        }
+        BOOST_FOREACH(Vertex child, boost::adjacent_vertices(v, dag)) {
+            push_candidate(v, child);
+        }
+        if (parents) {
+            for (Vertex parent: order.transitiveParents(v)) {
+                boost::remove_edge(parent, v, dag);
+            }
+            BOOST_FOREACH(Vertex parent, boost::inv_adjacent_vertices(v, dag)) {
+                push_candidate(parent, v);
+            }
+        }
+    };
+
+    BOOST_FOREACH(Vertex v, boost::vertices(dag)) {
+        update_vertex(v);
+    }
+    // NB: in reverse topological order, the path searches only traverse edges that have already been reduced
+    {
+        const vector<Vertex> topological_order = order.vertices();
+        BOOST_REVERSE_FOREACH(Vertex v, topological_order) {
+            update_edges(v, false);
+        }
+    }
+
+    // Each iteration merges the greatest weight edge that is still fusible. Since mergeability and weight only
+    // depend on the two blocks, only the edges of a merged vertex need new candidates. Merging never removes
+    // paths thus a transitive edge stays transitive and we can check for transitivity lazily.
+    while (not candidates.empty()) {
+        const Candidate c = candidates.top();
+        candidates.pop();
+        if (merged[c.src] or merged[c.dst] or version[c.src] != c.src_version or version[c.dst] != c.dst_version) {
+            continue; // The candidate is outdated
+        }
+        Edge edge;
+        bool edge_exist;
+        tie(edge, edge_exist) = boost::edge(c.src, c.dst, dag);
+        if (not edge_exist) {
+            continue;
+        }
+        if (order.longPathExist(c.src, c.dst)) {
+            boost::remove_edge(edge, dag); // Transitive edges cannot be merged
+            continue;
+        }
+        if (cost_model != nullptr) {
+            const Block merged = reshape_and_merge(dag[c.src].getLoop(), dag[c.dst].getLoop());
+            if (not cost_model->profitable(dag[c.src], dag[c.dst], merged)) {
+                continue; // The merge is predicted to be slower, which only changes if 'c.src' or 'c.dst' changes
+            }
         }
-        // Any more vertices to fuse?
-        if (fusibles.size() == 0) {
-            break;
+        merge_vertices(dag, c.src, c.dst, false);
+        merged[c.dst] = true;
+        ++version[c.src];
+        update_vertex(c.src);
+
+        // The parents of 'c.dst' are now parents of 'c.src', which might violate the topological order
+        vector<Vertex> parents;
+        BOOST_FOREACH(Vertex parent, boost::inv_adjacent_vertices(c.src, dag)) {
+            parents.push_back(parent);
         }
+        for (Vertex parent: parents) {
+            order.edgeAdded(parent, c.src);
+        }
+        update_edges(c.src, true);
+    }
+
+    // Finally, we remove the merged vertices
+    remove_vertices(dag, merged);
+    assert(validate(dag));
+}
+
+namespace {
 
-        // Let's find the greatest weight edge.
-        Edge greatest = fusibles.front();
-        uint64_t greatest_weight = weight(dag[source(greatest, dag)], dag[target(greatest, dag)]);
-        for (Edge e: fusibles) {
-            const uint64_t w = weight(dag[source(e, dag)], dag[target(e, dag)]);
-            if (w > greatest_weight) {
-                greatest = e;
-                greatest_weight = w;
+/* Branch-and-bound search for the set of merges that minimizes the total cost of a DAG, i.e. the bytes moved
+ * to and from non-temporary arrays summed over all blocks (see `block_cost()`). Ties are broken by the number
+ * of blocks.
+ *
+ * Each search node picks a fusible edge and branches into merging its vertices and forbidding them to ever be in
+ * the same block. Since a merge never increases the cost, the merge branch is searched first. A subtree is pruned
+ * when its lower bound is no better than the best DAG found. The lower bound is the cost of the components of the
+ * vertices that might still be merged, where each component is costed as if it was a single block.
+ *
+ * A forbidden pair is tracked by the original vertices, thus it also forbids the blocks that the two vertices
+ * are merged into later. This makes the edges between blocks that contain a forbidden pair permanently
+ * unmergeable, which is why the lower bound can exclude them: every block of a leaf is within a component.
+ *
+ * The merges are applied to the DAG in place and undone when backtracking.
+ */
+class OptimalSearch {
+    typedef pair<uint64_t, uint64_t> Cost; // The total block cost and the number of blocks
+    const bool _avoid_rank0_sweep;
+    const uint64_t _max_nodes;
+    const chrono::steady_clock::time_point _deadline;
+    uint64_t _num_nodes = 0;
+    bool _complete = true;
+    // Pairs of original vertices that must stay in separate blocks
+    vector<pair<Vertex, Vertex> > _forbidden;
+    // The vertex that each original vertex is merged into (itself when unmerged)
+    vector<Vertex> _owner;
+    // The original vertices merged into each vertex (incl. itself)
+    vector<vector<Vertex> > _members;
+
+    // The best DAG found, its merged vertices, and cost
+    DAG _best;
+    vector<bool> _best_merged;
+    Cost _best_cost;
+
+    // What is needed to undo the merge of 'b' into 'a'
+    struct Undo {
+        Vertex a, b;
+        Block a_block;
+        vector<Vertex> a_children, a_parents, b_children, b_parents;
+    };
+
+    Cost _cost(const DAG &dag, const vector<bool> &merged) const {
+        Cost ret(0, 0);
+        BOOST_FOREACH(Vertex v, boost::vertices(dag)) {
+            if (not merged[v]) {
+                ret.first += block_cost(dag[v]);
+                ++ret.second;
             }
         }
-        Vertex v1 = source(greatest, dag);
-        Vertex v2 = target(greatest, dag);
-//        cout << "merge: " << v1 << ", " << v2 << endl;
+        return ret;
+    }
 
-        assert(not path_exist(v1, v2, dag, true)); // Transitive edges should have been removed by now
+    // Returns true when the blocks of 'a' and 'b' contain a forbidden pair, thus they can never be merged
+    bool _isForbidden(Vertex a, Vertex b) const {
+        for (const pair<Vertex, Vertex> &f: _forbidden) {
+            const Vertex x = _owner[f.first], y = _owner[f.second];
+            if ((x == a and y == b) or (x == b and y == a)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        merge_vertices(dag, v1, v2, true);
+    Undo _merge(DAG &dag, vector<bool> &merged, Vertex a, Vertex b) {
+        Undo ret{a, b, dag[a], {}, {}, {}, {}};
+        BOOST_FOREACH(Vertex v, boost::adjacent_vertices(a, dag)) {
+            ret.a_children.push_back(v);
+        }
+        BOOST_FOREACH(Vertex v, boost::inv_adjacent_vertices(a, dag)) {
+            ret.a_parents.push_back(v);
+        }
+        BOOST_FOREACH(Vertex v, boost::adjacent_vertices(b, dag)) {
+            ret.b_children.push_back(v);
+        }
+        BOOST_FOREACH(Vertex v, boost::inv_adjacent_vertices(b, dag)) {
+            ret.b_parents.push_back(v);
+        }
+        merge_vertices(dag, a, b, false);
+        merged[b] = true;
+        for (Vertex v: _members[b]) {
+            _owner[v] = a;
+        }
+        _members[a].insert(_members[a].end(), _members[b].begin(), _members[b].end());
+        return ret;
+    }
+
+    void _undo(DAG &dag, vector<bool> &merged, const Undo &undo) {
+        _members[undo.a].resize(_members[undo.a].size() - _members[undo.b].size());
+        for (Vertex v: _members[undo.b]) {
+            _owner[v] = undo.b;
+        }
+        merged[undo.b] = false;
+        // NB: `merge_vertices()` leaves the block of 'b' untouched
+        boost::clear_vertex(undo.a, dag);
+        dag[undo.a] = undo.a_block;
+        for (Vertex v: undo.a_children) {
+            boost::add_edge(undo.a, v, dag);
+        }
+        for (Vertex v: undo.a_parents) {
+            boost::add_edge(v, undo.a, dag);
+        }
+        for (Vertex v: undo.b_children) {
+            boost::add_edge(undo.b, v, dag);
+        }
+        for (Vertex v: undo.b_parents) {
+            boost::add_edge(v, undo.b, dag);
+        }
+    }
+
+    Cost _lowerBound(const DAG &dag, const vector<bool> &merged) const {
+        // Find the components of vertices connected by edges that might be merged
+        vector<Vertex> component(boost::num_vertices(dag));
+        std::iota(component.begin(), component.end(), 0);
+        std::function<Vertex(Vertex)> find_root = [&](Vertex v) -> Vertex {
+            return component[v] == v ? v : component[v] = find_root(component[v]);
+        };
+        BOOST_FOREACH(Edge e, boost::edges(dag)) {
+            const Vertex a = source(e, dag), b = target(e, dag);
+            if (not dag[a].isInstr() and not dag[b].isInstr() and not _isForbidden(a, b)) {
+                component[find_root(a)] = find_root(b);
+            }
+        }
+        // Cost each component as a single block where arrays both created and destroyed are temporary
+        map<Vertex, set<const bh_base *> > bases;
+        map<Vertex, set<bh_base *> > news, frees;
+        Cost ret(0, 0);
+        BOOST_FOREACH(Vertex v, boost::vertices(dag)) {
+            if (merged[v]) {
+                continue;
+            }
+            if (dag[v].isInstr()) {
+                ret.first += block_cost(dag[v]);
+                ++ret.second;
+            } else {
+                const Vertex root = find_root(v);
+                const set<const bh_base *> b = dag[v].getAllBases();
+                bases[root].insert(b.begin(), b.end());
+                dag[v].getLoop().getAllNews(news[root]);
+                dag[v].getLoop().getAllFrees(frees[root]);
+            }
+        }
+        for (const auto &component_bases: bases) {
+            const set<bh_base *> &n = news[component_bases.first];
+            const set<bh_base *> &f = frees[component_bases.first];
+            for (const bh_base *base: component_bases.second) {
+                bh_base *b = const_cast<bh_base *>(base);
+                if (not (util::exist(n, b) and util::exist(f, b))) {
+                    ret.first += base->nbytes();
+                }
+            }
+            ++ret.second;
+        }
+        return ret;
+    }
+
+    void _search(DAG &dag, vector<bool> &merged) {
+        if (++_num_nodes > _max_nodes or chrono::steady_clock::now() > _deadline) {
+            _complete = false;
+            return;
+        }
+        if (not (_lowerBound(dag, merged) < _best_cost)) {
+            return;
+        }
+        // Find the fusible edge with the greatest weight
+        bool found = false;
+        Vertex a = 0, b = 0;
+        uint64_t greatest_weight = 0;
+        BOOST_FOREACH(Edge e, boost::edges(dag)) {
+            const Vertex v1 = source(e, dag), v2 = target(e, dag);
+            if (not _isForbidden(v1, v2) and mergeable(dag[v1], dag[v2], _avoid_rank0_sweep) and
+                not path_exist(v1, v2, dag, true)) {
+                const uint64_t w = weight(dag[v1], dag[v2]);
+                if (not found or w > greatest_weight) {
+                    found = true;
+                    a = v1;
+                    b = v2;
+                    greatest_weight = w;
+                }
+            }
+        }
+        if (not found) { // A leaf
+            const Cost cost = _cost(dag, merged);
+            if (cost < _best_cost) {
+                _best = dag;
+                _best_merged = merged;
+                _best_cost = cost;
+            }
+            return;
+        }
+        {
+            const Undo undo = _merge(dag, merged, a, b);
+            _search(dag, merged);
+            _undo(dag, merged, undo);
+        }
+        _forbidden.push_back(make_pair(a, b));
+        _search(dag, merged);
+        _forbidden.pop_back();
+    }
+
+public:
+    OptimalSearch(bool avoid_rank0_sweep, uint64_t max_nodes, double max_seconds) :
+            _avoid_rank0_sweep(avoid_rank0_sweep), _max_nodes(max_nodes),
+            _deadline(chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                    chrono::duration<double>(max_seconds))) {}
+
+    // Search for the best merges of 'dag' starting with 'initial' as the best DAG found
+    // Returns whether the search completed within the limits
+    bool run(DAG &dag, DAG initial) {
+        _best = std::move(initial);
+        _best_merged.assign(boost::num_vertices(_best), false);
+        _best_cost = _cost(_best, _best_merged);
+        const size_t num_vertices = boost::num_vertices(dag);
+        _owner.resize(num_vertices);
+        _members.resize(num_vertices);
+        for (Vertex v = 0; v < num_vertices; ++v) {
+            _owner[v] = v;
+            _members[v] = {v};
+        }
+        vector<bool> merged(num_vertices, false);
+        _search(dag, merged);
+        remove_vertices(_best, _best_merged);
+        dag = std::move(_best);
+        return _complete;
+    }
+};
+}
+
+bool optimal(DAG &dag, bool avoid_rank0_sweep, uint64_t max_nodes, double max_seconds) {
+    // The greedy fusion is the first best DAG, which we fall back to if the search is stopped early
+    DAG initial = dag;
+    greedy(initial, avoid_rank0_sweep);
+    OptimalSearch search(avoid_rank0_sweep, max_nodes, max_seconds);
+    const bool ret = search.run(dag, std::move(initial));
+    // When the search was stopped early, the best DAG might have fusible edges that the search forbade in order to
+    // reach other merges. Since a merge never increases the cost, we merge them as well.
+    // NB: a completed search is optimal thus no merge is left
+    if (not ret) {
+        greedy(dag, avoid_rank0_sweep);
     }
     assert(validate(dag));
+    return ret;
 }
 
 } // graph
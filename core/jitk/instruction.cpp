@@ -19,6 +19,7 @@ If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <sstream>
+#include <limits>
 
 #include <bohrium/bh_instruction.hpp>
 #include <bohrium/jitk/block.hpp>
@@ -543,6 +544,133 @@ void write_operation(const bh_instruction &instr, const vector <string> &ops, st
     out << "\n";
 }
 
+bool vector_operation_compatible(const bh_instruction &instr) {
+    const bh_type t0 = instr.operand_type(0);
+    if (not(bh_type_is_integer(t0) or t0 == bh_type::FLOAT32 or t0 == bh_type::FLOAT64)) {
+        return false;
+    }
+    // Except for type conversions, the input operands must have the type of the output
+    for (size_t o = 1; o < instr.operand.size(); ++o) {
+        const bh_type t = instr.operand_type(o);
+        if (instr.operand[o].isConstant()) {
+            continue;
+        } else if (instr.opcode == BH_IDENTITY) {
+            if (not(bh_type_is_integer(t) or t == bh_type::FLOAT32 or t == bh_type::FLOAT64)) {
+                return false;
+            }
+        } else if (t != t0) {
+            return false;
+        }
+    }
+    switch (instr.opcode) {
+        case BH_IDENTITY:
+        case BH_ADD:
+        case BH_SUBTRACT:
+        case BH_MULTIPLY:
+        case BH_MAXIMUM:
+        case BH_MINIMUM:
+        case BH_ADD_REDUCE:
+        case BH_MULTIPLY_REDUCE:
+        case BH_MAXIMUM_REDUCE:
+        case BH_MINIMUM_REDUCE:
+            return true;
+        case BH_DIVIDE: // NB: the integer division follows Python
+            return not bh_type_is_integer(t0);
+        case BH_BITWISE_AND:
+        case BH_BITWISE_OR:
+        case BH_BITWISE_XOR:
+        case BH_BITWISE_AND_REDUCE:
+        case BH_BITWISE_OR_REDUCE:
+        case BH_BITWISE_XOR_REDUCE:
+            return bh_type_is_integer(t0) != 0;
+        default:
+            return false;
+    }
+}
+
+namespace {
+// Write the select `cond ? a : b` of vectors where `cond` is a comparison of `a` and `b`
+// NB: C doesn't support the ternary operator on vectors thus we select using the bits of the comparison mask
+void write_vector_select(const string &cond, const string &a, const string &b, const string &vtype,
+                         const string &mtype, stringstream &out) {
+    out << "(" << vtype << ")(((" << mtype << ")" << a << " & (" << cond << ")) | ((" << mtype << ")" << b
+        << " & ~(" << cond << ")))";
+}
+}
+
+void write_vector_operation(const bh_instruction &instr, const vector<string> &ops, const string &vtype,
+                            const string &mtype, stringstream &out) {
+    switch (instr.opcode) {
+        case BH_IDENTITY:
+            if (instr.operand[1].isConstant() or instr.operand_type(0) == instr.operand_type(1)) {
+                out << ops[0] << " = " << ops[1] << ";";
+            } else {
+                out << ops[0] << " = __builtin_convertvector(" << ops[1] << ", " << vtype << ");";
+            }
+            break;
+        case BH_ADD:
+            out << ops[0] << " = " << ops[1] << " + " << ops[2] << ";";
+            break;
+        case BH_ADD_REDUCE:
+            out << ops[0] << " += " << ops[1] << ";";
+            break;
+        case BH_SUBTRACT:
+            out << ops[0] << " = " << ops[1] << " - " << ops[2] << ";";
+            break;
+        case BH_MULTIPLY:
+            out << ops[0] << " = " << ops[1] << " * " << ops[2] << ";";
+            break;
+        case BH_MULTIPLY_REDUCE:
+            out << ops[0] << " *= " << ops[1] << ";";
+            break;
+        case BH_DIVIDE:
+            out << ops[0] << " = " << ops[1] << " / " << ops[2] << ";";
+            break;
+        case BH_BITWISE_AND:
+            out << ops[0] << " = " << ops[1] << " & " << ops[2] << ";";
+            break;
+        case BH_BITWISE_AND_REDUCE:
+            out << ops[0] << " &= " << ops[1] << ";";
+            break;
+        case BH_BITWISE_OR:
+            out << ops[0] << " = " << ops[1] << " | " << ops[2] << ";";
+            break;
+        case BH_BITWISE_OR_REDUCE:
+            out << ops[0] << " |= " << ops[1] << ";";
+            break;
+        case BH_BITWISE_XOR:
+            out << ops[0] << " = " << ops[1] << " ^ " << ops[2] << ";";
+            break;
+        case BH_BITWISE_XOR_REDUCE:
+            out << ops[0] << " ^= " << ops[1] << ";";
+            break;
+        case BH_MAXIMUM:
+            out << ops[0] << " = ";
+            write_vector_select(ops[1] + " > " + ops[2], ops[1], ops[2], vtype, mtype, out);
+            out << ";";
+            break;
+        case BH_MAXIMUM_REDUCE:
+            out << ops[0] << " = ";
+            write_vector_select(ops[0] + " > " + ops[1], ops[0], ops[1], vtype, mtype, out);
+            out << ";";
+            break;
+        case BH_MINIMUM:
+            out << ops[0] << " = ";
+            write_vector_select(ops[1] + " < " + ops[2], ops[1], ops[2], vtype, mtype, out);
+            out << ";";
+            break;
+        case BH_MINIMUM_REDUCE:
+            out << ops[0] << " = ";
+            write_vector_select(ops[0] + " < " + ops[1], ops[0], ops[1], vtype, mtype, out);
+            out << ";";
+            break;
+        default:
+            cerr << "Instruction \"" << instr << "\" not supported as a vector operation\n";
+            throw runtime_error("Instruction not supported as a vector operation.");
+    }
+    out << "\n";
+}
+
 bh_constant sweep_identity(bh_opcode opcode, bh_type dtype) {
     switch (opcode) {
         case BH_ADD_REDUCE:
@@ -557,16 +685,16 @@ bh_constant sweep_identity(bh_opcode opcode, bh_type dtype) {
             return bh_constant(1, dtype);
         case BH_BITWISE_AND_REDUCE:
         case BH_LOGICAL_AND_REDUCE:
-            return bh_constant(~0u, dtype);
+            return bh_constant(~uint64_t{0}, dtype); // NB: all bits set, also of the 64-bit types
         case BH_MAXIMUM_REDUCE:
-            if (dtype == bh_type::BOOL) {
-                return bh_constant(bh_bool{1});
+            if (dtype == bh_type::FLOAT32 or dtype == bh_type::FLOAT64) { // NB: `get_min()` is the smallest positive
+                return bh_constant(-std::numeric_limits<double>::infinity(), dtype);
             } else {
                 return bh_constant::get_min(dtype);
             }
         case BH_MINIMUM_REDUCE:
-            if (dtype == bh_type::BOOL) {
-                return bh_constant(bh_bool{1});
+            if (dtype == bh_type::FLOAT32 or dtype == bh_type::FLOAT64) {
+                return bh_constant(std::numeric_limits<double>::infinity(), dtype);
             } else {
                 return bh_constant::get_max(dtype);
             }
@@ -32,11 +32,13 @@ SymbolTable::SymbolTable(const LoopB &kernel,
                          bool use_volatile,
                          bool strides_as_var,
                          bool index_as_var,
-                         bool const_as_var) : _useRandom(false),
+                         bool const_as_var,
+                         bool sizes_as_var) : _useRandom(false),
                                               use_volatile(use_volatile),
                                               strides_as_var(strides_as_var),
                                               index_as_var(index_as_var),
-                                              const_as_var(const_as_var) {
+                                              const_as_var(const_as_var),
+                                              sizes_as_var(sizes_as_var) {
 
     // NB: by assigning the IDs in the order they appear in the 'instr_list',
     //     the kernels can better be reused
@@ -96,6 +98,17 @@ SymbolTable::SymbolTable(const LoopB &kernel,
             _offset_stride_views[v.second] = &(v.first);
         }
     }
+    // NB: the loops get their IDs in the order they are written thus the kernels can better be reused
+    if (sizes_as_var) {
+        vector<const LoopB *> loops;
+        kernel.getAllSubBlocks(loops);
+        for (const LoopB *loop: loops) {
+            if (loop->size > 1) {
+                _loop_size_map.insert(std::make_pair(loop, _loop_size_blocks.size()));
+                _loop_size_blocks.push_back(loop);
+            }
+        }
+    }
 }
 
 
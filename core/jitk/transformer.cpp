@@ -18,6 +18,12 @@ GNU Lesser General Public License along with Bohrium.
 If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
 #include <bohrium/jitk/transformer.hpp>
 #include <bohrium/jitk/iterator.hpp>
 
@@ -140,6 +146,204 @@ bool collapse_loop_with_child(LoopB &loop) {
     }
     return false;
 }
+
+// Returns the largest divisor of 'size' in the range [tile_size/2, tile_size] or zero if none exist
+int64_t tile_extent(int64_t size, int64_t tile_size) {
+    for (int64_t t = tile_size; t > 0 and t >= tile_size / 2; --t) {
+        if (size % t == 0) {
+            return t;
+        }
+    }
+    return 0;
+}
+
+// Help function that returns the innermost block of 'loop' if 'loop' is a perfect nest, i.e. each loop has exactly
+// one child except the innermost loop, which only has instructions with the same number of dimensions.
+// Unless 'allow_sweeps' is true, the loops must also be parallel thus no sweeps, gathers, or scatters.
+// Returns NULL if not.
+const LoopB *find_perfect_nest(const LoopB &loop, bool allow_sweeps = false) {
+    const LoopB *cur = &loop;
+    while (cur->_block_list.size() == 1 and not cur->_block_list[0].isInstr()) {
+        cur = &cur->_block_list[0].getLoop();
+    }
+    const int64_t ndim = cur->rank + 1;
+    for (const Block &b: cur->_block_list) {
+        if (not b.isInstr()) {
+            return NULL;
+        }
+        const bh_instruction &instr = *b.getInstr();
+        if (instr.operand.empty() or instr.ndim() != ndim) {
+            return NULL;
+        }
+        if (not allow_sweeps and (bh_opcode_is_sweep(instr.opcode) or instr.opcode == BH_GATHER or
+                                  instr.opcode == BH_SCATTER or instr.opcode == BH_COND_SCATTER)) {
+            return NULL;
+        }
+    }
+    return cur;
+}
+
+// Help function that returns the number of non-contiguous array accesses in 'instr_list' along 'axis'
+// where 'axis' is an axis of the dominating shape of the instructions
+int64_t num_strided_accesses(const vector<InstrPtr> &instr_list, int64_t axis) {
+    int64_t ret = 0;
+    for (const InstrPtr &instr: instr_list) {
+        const int sa = instr->sweep_axis();
+        for (size_t o = 0; o < instr->operand.size(); ++o) {
+            const bh_view &view = instr->operand[o];
+            // The input array of gather and the output array of scatter have arbitrary shape and stride
+            if (view.isConstant() or (o == 1 and instr->opcode == BH_GATHER) or
+                (o == 0 and (instr->opcode == BH_SCATTER or instr->opcode == BH_COND_SCATTER))) {
+                continue;
+            }
+            int64_t view_axis = axis;
+            if (o == 0 and bh_opcode_is_reduction(instr->opcode)) { // The output of a reduction has no sweep axis
+                if (sa == axis) {
+                    continue;
+                }
+                view_axis = sa < axis ? axis - 1 : axis;
+            }
+            if (std::abs(view.stride[view_axis]) > 1) {
+                ++ret;
+            }
+        }
+    }
+    return ret;
+}
+
+// Help function that permutes the axes of the perfect nest 'loop' such that the innermost loop has the fewest
+// non-contiguous array accesses. Sweeped axes are not moved thus reductions and accumulations are preserved.
+// Returns false if the nest isn't interchanged.
+bool interchange_loop(LoopB &loop) {
+    const LoopB *inner = find_perfect_nest(loop, true);
+    if (inner == NULL) {
+        return false;
+    }
+    vector<InstrPtr> instr_list;
+    for (const Block &b: inner->_block_list) {
+        instr_list.push_back(b.getInstr());
+    }
+
+    // The axes we can move (in their current order) and their number of non-contiguous accesses
+    vector<int64_t> axes;
+    map<int64_t, int64_t> strided;
+    for (int64_t axis = loop.rank; axis <= inner->rank; ++axis) {
+        bool sweeped = false;
+        for (const InstrPtr &instr: instr_list) {
+            sweeped |= instr->sweep_axis() == axis;
+        }
+        if (not sweeped) {
+            axes.push_back(axis);
+            strided[axis] = num_strided_accesses(instr_list, axis);
+        }
+    }
+    if (axes.size() < 2) {
+        return false;
+    }
+
+    // We order the axes by decreasing number of non-contiguous accesses but only interchange when it improves
+    // the innermost axis
+    vector<int64_t> order(axes);
+    std::stable_sort(order.begin(), order.end(), [&strided](int64_t a, int64_t b) {
+        return strided[a] > strided[b];
+    });
+    if (strided[order.back()] >= strided[axes.back()]) {
+        return false;
+    }
+
+    // Let's permute the axes one swap at a time where `current[i]` is the original axis now at `axes[i]`
+    vector<int64_t> current(axes);
+    vector<bh_instruction> new_instrs;
+    for (const InstrPtr &instr: instr_list) {
+        new_instrs.push_back(*instr);
+    }
+    for (size_t i = 0; i < axes.size(); ++i) {
+        const size_t j = std::find(current.begin(), current.end(), order[i]) - current.begin();
+        if (i != j) {
+            for (bh_instruction &instr: new_instrs) {
+                instr.transpose(axes[i], axes[j]);
+            }
+            std::swap(current[i], current[j]);
+        }
+    }
+    instr_list.clear();
+    for (bh_instruction &instr: new_instrs) {
+        instr_list.push_back(std::make_shared<bh_instruction>(std::move(instr)));
+    }
+    Block nest = create_nested_block(instr_list, loop.rank, loop.getAllFrees());
+    loop = std::move(nest.getLoop());
+    return true;
+}
+
+// Help function that tiles the two innermost axes of the perfect nest 'loop' (see `find_perfect_nest()`).
+// The axes are split into outer tile loops followed by inner loops that iterate within a tile:
+//     [..., a, b] => [..., a/ta, b/tb, ta, tb]
+// Returns false if the nest isn't tiled, which is the case when all arrays are accessed contiguously
+// in the innermost axis or when the axis sizes have no suitable tile sizes.
+bool tile_loop(LoopB &loop, uint64_t tile_size) {
+    const LoopB *inner = find_perfect_nest(loop);
+    // NB: the two new axes must not exceed `BH_MAXDIM`
+    if (inner == NULL or inner->rank - loop.rank < 1 or inner->rank + 3 > BH_MAXDIM) {
+        return false;
+    }
+    const int64_t a = inner->rank - 1;
+    const int64_t b = inner->rank;
+
+    // Only non-contiguous accesses in the innermost axis benefit from tiling
+    bool non_contiguous = false;
+    std::set<bh_view> views;
+    for (const Block &block: inner->_block_list) {
+        for (const bh_view &view: block.getInstr()->operand) {
+            if (not view.isConstant()) {
+                non_contiguous |= view.stride[b] != 0 and view.stride[b] != 1;
+                views.insert(view);
+            }
+        }
+    }
+    if (not non_contiguous) {
+        return false;
+    }
+
+    // Without a tile size, we find the largest power of two where a tile of each view fits in the L1 cache
+    if (tile_size == 0) {
+        uint64_t nbytes = 0;
+        for (const bh_view &view: views) {
+            nbytes += bh_type_size(view.base->dtype());
+        }
+        tile_size = 8;
+        while (tile_size < 512 and (tile_size * 2) * (tile_size * 2) * nbytes <= l1_cache_size()) {
+            tile_size *= 2;
+        }
+    }
+    const int64_t size_a = inner->_block_list[0].getInstr()->operand[0].shape[a];
+    const int64_t size_b = inner->_block_list[0].getInstr()->operand[0].shape[b];
+    const int64_t ta = tile_extent(size_a, tile_size);
+    const int64_t tb = tile_extent(size_b, tile_size);
+    // NB: we require that the tiles divide the axes since remainder loops would break the nest
+    if (ta == 0 or tb == 0 or ta == size_a or tb == size_b) {
+        return false;
+    }
+
+    vector<InstrPtr> instr_list;
+    for (const Block &block: inner->_block_list) {
+        bh_instruction instr(*block.getInstr());
+        for (bh_view &view: instr.operand) {
+            if (not view.isConstant()) {
+                const int64_t sa = view.stride[a];
+                const int64_t sb = view.stride[b];
+                view.shape.resize(static_cast<size_t>(a));
+                view.stride.resize(static_cast<size_t>(a));
+                view.shape.insert(view.shape.end(), {size_a / ta, size_b / tb, ta, tb});
+                view.stride.insert(view.stride.end(), {sa * ta, sb * tb, sa, sb});
+                view.ndim += 2;
+            }
+        }
+        instr_list.push_back(std::make_shared<bh_instruction>(instr));
+    }
+    Block tiled = create_nested_block(instr_list, loop.rank, loop.getAllFrees());
+    loop = std::move(tiled.getLoop());
+    return true;
+}
 }
 
 void push_reductions_inwards(vector<Block> &block_list) {
@@ -244,6 +448,53 @@ void collapse_redundant_axes(vector<Block> &block_list) {
     }
     block_list = ret;
 }
+
+uint64_t loop_interchange(vector<Block> &block_list) {
+    uint64_t ret = 0;
+    for (Block &b: block_list) {
+        if (b.isInstr()) {
+            continue;
+        }
+        if (interchange_loop(b.getLoop())) {
+            ++ret;
+        } else { // If the loop isn't interchanged, we might find a perfect nest within it
+            const uint64_t count = loop_interchange(b.getLoop()._block_list);
+            if (count > 0) {
+                b.getLoop().metadataUpdate();
+                ret += count;
+            }
+        }
+    }
+    return ret;
+}
+
+uint64_t l1_cache_size() {
+    static const uint64_t ret = []() -> uint64_t {
+        long size = -1;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+        size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+        if (size <= 0) { // Let's try sysfs, which writes the size as e.g. "32K"
+            std::ifstream file("/sys/devices/system/cpu/cpu0/cache/index0/size");
+            char unit = 0;
+            if (file >> size >> unit and unit == 'K') {
+                size *= 1024;
+            }
+        }
+        return size > 0 ? static_cast<uint64_t>(size) : 32 * 1024;
+    }();
+    return ret;
+}
+
+void tile(vector<Block> &block_list, uint64_t tile_size) {
+    for (Block &b: block_list) {
+        // If the loop isn't tiled, we might find a perfect nest within it
+        if (not b.isInstr() and not tile_loop(b.getLoop(), tile_size)) {
+            tile(b.getLoop()._block_list, tile_size);
+            b.getLoop().metadataUpdate();
+        }
+    }
+}
 } // jitk
 } // bohrium
 
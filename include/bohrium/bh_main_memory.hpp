@@ -20,7 +20,10 @@ If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <cstddef>
+#include <functional>
+#include <map>
 #include <bohrium/bh_base.hpp>
+#include <bohrium/bh_malloc_cache.hpp>
 
 /** Return the size of the physical memory on this machine */
 uint64_t bh_main_memory_total();
@@ -57,3 +60,24 @@ void bh_set_malloc_cache_limit(uint64_t nbytes);
  * @param max_memory_usage Total memory usage, which includes ALL memory allocated through the memory cache
  */
 void bh_get_malloc_cache_stat(uint64_t &cache_lookup, uint64_t &cache_misses, uint64_t &max_memory_usage);
+
+/** Retrieve the lookup statistics of each size class of the main memory malloc cache
+ *
+ * @return The statistics by size class in bytes (see MallocCache::sizeClass())
+ */
+std::map<uint64_t, bohrium::MallocCache::BinStat> bh_get_malloc_cache_bin_stat();
+
+/** Back data regions of 2MB and up with transparent huge pages (using `madvise(MADV_HUGEPAGE)`), which
+ *  reduces the TLB misses of large arrays. Disabled by default.
+ *
+ * @param enable Enable or disable huge pages for new data regions
+ */
+void bh_set_main_memory_hugepage(bool enable);
+
+/** Set a function that is called with each data region that is allocated from the operating system
+ *  (i.e. not reused from the malloc cache), before the region is used. This makes it possible to control
+ *  the NUMA placement of the pages of the region.
+ *
+ * @param hook The function, which takes the data region and its size in bytes. Use nullptr to remove the hook.
+ */
+void bh_set_main_memory_hook(std::function<void(void *mem, uint64_t nbytes)> hook);
@@ -20,6 +20,10 @@ If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <vector>
+#include <list>
+#include <deque>
+#include <map>
+#include <unordered_map>
 #include <sstream>
 #include <stdexcept>
 #include <bohrium/bh_util.hpp>
@@ -29,19 +33,39 @@ namespace bohrium {
 /** Cache of memory allocations. Instead of freeing a memory allocation immediately, this cache
  * retain the allocation for later reuse.
  * To use, simply allocate and free all memory allocations through the method `alloc()` and `free()`
+ *
+ * Allocations are rounded up to a size class (see `sizeClass()`) and the cache has a bin per size class,
+ * which makes it possible to reuse an allocation for an array of a slightly different size in constant time.
  */
 class MallocCache {
 public:
     typedef std::function<void *(uint64_t)> FuncAllocT;
     typedef std::function<void(void *, uint64_t)> FuncFreeT;
 
+    // The lookup statistics of a size class
+    struct BinStat {
+        uint64_t lookups = 0;
+        uint64_t misses = 0;
+    };
+
+    // The granularity of the size classes (the page size)
+    static constexpr uint64_t GRANULARITY = 4096;
+
 private:
     // A segment consist of a memory allocation and a size
     struct Segment {
         std::uint64_t nbytes;
         void *mem;
     };
-    std::vector<Segment> _segments; // Segments in the cache
+    // Segments in the cache ordered by the time they were freed (the least recently freed first)
+    std::list<Segment> _segments;
+
+    // The segments of a size class ordered like `_segments`
+    struct Bin {
+        std::deque<std::list<Segment>::iterator> segments;
+        BinStat stat;
+    };
+    std::unordered_map<uint64_t, Bin> _bins; // Bins by size class
 
     // Pointers to malloc and free functions
     FuncAllocT _func_alloc;
@@ -78,39 +102,17 @@ private:
         _mem_allocated -= nbytes;
     }
 
-    /** Evict a range of memory allocations from the cache
-     *
-     * @param first Iterator pointing to the first allocation
-     * @param last Iterator pointing to the element just after the last allocation
-     * @param call_free When true, the memory allocations are also freed
-     */
-    void _evict(std::vector<Segment>::iterator first, std::vector<Segment>::iterator last, bool call_free) {
-        for (auto it = first; it != last; ++it) {
-            if (call_free) {
-                _free(it->mem, it->nbytes);
-            }
-            _cache_size -= it->nbytes;
-        }
-        _segments.erase(first, last);
-    }
-
-    /** Evict a memory allocation from the cache
-     *
-     * @param position Iterator pointing to the allocation
-     * @param call_free When true, the memory allocations are also freed
-     */
-    void _evict(std::vector<Segment>::iterator position, bool call_free) {
-        _evict(position, std::next(position), call_free);
-    }
-
-    /** Evict a memory allocation from the cache
-     * 
-     * @param position Reverse iterator pointing to the allocation
-     * @param call_free When true, the memory allocations are also freed
-     */
-    void _evict(std::vector<Segment>::reverse_iterator position, bool call_free) {
-        // Notice, we need to iterate `position` once when converting from reverse to regular iterator
-        _evict(std::next(position).base(), call_free);
+    /** Evict the least recently freed memory allocation from the cache and free it */
+    void _evictOldest() {
+        assert(not _segments.empty());
+        const auto oldest = _segments.begin();
+        Bin &bin = _bins.at(oldest->nbytes);
+        // NB: since bins are ordered like `_segments`, the oldest segment is first in its bin
+        assert(bin.segments.front() == oldest);
+        bin.segments.pop_front();
+        _free(oldest->mem, oldest->nbytes);
+        _cache_size -= oldest->nbytes;
+        _segments.erase(oldest);
     }
 
 public:
@@ -124,6 +126,26 @@ public:
     MallocCache(FuncAllocT func_alloc, FuncFreeT func_free, uint64_t limit_num_bytes) :
             _func_alloc(func_alloc), _func_free(func_free), _mem_allocated_limit(limit_num_bytes) {}
 
+    /** Return the size class of `nbytes`, which is the number of bytes actually allocated.
+     * Allocations up to 64 pages are rounded up to whole pages. Larger allocations use eight size classes per
+     * power of two, which bounds the waste to 12.5%. Size classes of 16MB and up are multiples of the huge page
+     * size (2MB).
+     *
+     * @param nbytes The requested number of bytes
+     * @return The size class
+     */
+    static uint64_t sizeClass(uint64_t nbytes) {
+        uint64_t step = GRANULARITY;
+        if (nbytes > 64 * GRANULARITY) {
+            uint64_t power_of_two = 64 * GRANULARITY;
+            while (power_of_two * 2 < nbytes) {
+                power_of_two *= 2;
+            }
+            step = power_of_two / 8;
+        }
+        return (nbytes + step - 1) / step * step;
+    }
+
     /** Pretty print the cache */
     std::string pprint() {
         std::stringstream ss;
@@ -141,11 +163,10 @@ public:
      */
     uint64_t shrink(uint64_t nbytes) {
         uint64_t count = 0;
-        std::vector<Segment>::iterator it;
-        for (it = _segments.begin(); it != _segments.end() and count < nbytes; ++it) {
-            count += it->nbytes;
+        while (not _segments.empty() and count < nbytes) {
+            count += _segments.front().nbytes;
+            _evictOldest();
         }
-        _evict(_segments.begin(), it, true);
         return count;
     }
 
@@ -188,37 +209,44 @@ public:
             return nullptr;
         }
         ++_stat_lookups;
-        // Check for segment of size `nbytes`, which is a cache hit!
-        for (auto it = _segments.rbegin(); it != _segments.rend(); ++it) { // Search in reverse
-            if (it->nbytes == nbytes) {
-                void *ret = it->mem;
-                assert(ret != nullptr);
-                _evict(it, false);
-                return ret;
-            }
+        const uint64_t size = sizeClass(nbytes);
+        Bin &bin = _bins[size];
+        ++bin.stat.lookups;
+
+        // Any segment in the bin is a cache hit! We take the most recently freed.
+        if (not bin.segments.empty()) {
+            const auto it = bin.segments.back();
+            bin.segments.pop_back();
+            void *ret = it->mem;
+            assert(ret != nullptr);
+            _cache_size -= size;
+            _segments.erase(it);
+            return ret;
         }
         ++_stat_misses;
+        ++bin.stat.misses;
 
         // Since we are allocating new memory, we might have to shrink to fit `_mem_allocated_limit`
-        shrinkToFitLimit(nbytes);
+        shrinkToFitLimit(size);
 
-        void *ret = _malloc(nbytes); // Cache miss
+        void *ret = _malloc(size); // Cache miss
         return ret;
     }
 
     /** Frees a memory allocation of size `nbytes`
      *
-     * @param nbytes The size of the memory allocation
+     * @param nbytes The size of the memory allocation (as given to `alloc()`)
      * @param memory The memory allocation
      */
     void free(uint64_t nbytes, void *memory) {
+        const uint64_t size = sizeClass(nbytes);
         if (_mem_allocated_limit == 0) {
-            _free(memory, nbytes);
+            _free(memory, size);
         } else {
-            // Insert the segment at the end of `_segments`
-            Segment seg{nbytes, memory};
-            _segments.push_back(seg);
-            _cache_size += nbytes;
+            // Insert the segment at the end of `_segments` and its bin
+            _segments.push_back(Segment{size, memory});
+            _bins[size].segments.push_back(std::prev(_segments.end()));
+            _cache_size += size;
         }
     }
 
@@ -254,6 +282,15 @@ public:
     uint64_t getMaxMemAllocated() const {
         return _stat_allocated_max;
     }
+
+    /** Return the lookup statistics of each size class (key: size class in bytes) */
+    std::map<uint64_t, BinStat> getBinStats() const {
+        std::map<uint64_t, BinStat> ret;
+        for (const auto &bin: _bins) {
+            ret[bin.first] = bin.second.stat;
+        }
+        return ret;
+    }
 };
 
 
@@ -23,6 +23,7 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <atomic>
 #include <boost/variant/variant.hpp>
 #include <boost/variant/get.hpp>
 
@@ -73,7 +74,8 @@ public:
 
     // Default Constructor
     LoopB() : rank(-42), size(-42) {
-        static int id_count = 0;
+        // NB: the fuser threads (see `fuser_threads`) construct blocks concurrently
+        static std::atomic<int> id_count(0);
         _id = id_count++;
     }
 
@@ -0,0 +1,149 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <map>
+#include <string>
+#include <cstdint>
+#include <boost/filesystem.hpp>
+
+namespace bohrium {
+namespace jitk {
+
+/* A manifest of the JIT kernels in a cache dir, which is a memory-mapped file shared by all processes.
+ * It maps a kernel (the hash of its source and the hash of the compilation command) to the shared library
+ * and symbol that implements it, thus lookups never scan the cache dir. The manifest also counts the files of the
+ * cache dir, thus the eviction only scans the cache dir when there are too many files. It uses the last use of the
+ * kernels in the manifest as an LRU hint. Other files, such as the fuse cache files, are ordered by their
+ * modification time.
+ * NB: all access to the file is protected by `flock()`. Lookups only take a shared lock and register their
+ *     use in the process, which is written to the manifest at the next insert or eviction (or on destruction).
+ */
+class CacheManifest {
+public:
+    // A kernel in the manifest
+    struct Entry {
+        uint64_t hash;             // Hash of the kernel source
+        uint64_t compilation_hash; // Hash of the compile command
+        uint64_t library;          // The shared library is named `hash_filename(compilation_hash, library, ".so")`
+        uint64_t size;             // Size of the shared library in bytes
+        int64_t last_use;          // Microseconds since epoch of the last lookup or insert (see `_uses`)
+        uint64_t hits;             // Number of lookups that found this kernel
+        char symbol[64];           // The kernel function within the shared library
+    };
+
+private:
+    // The header of the manifest file, which is followed by `capacity` entries
+    struct Header {
+        uint64_t magic;
+        uint64_t version;
+        uint64_t count;      // Number of entries in use
+        uint64_t capacity;   // Number of entries in the file
+        uint64_t generation; // Incremented whenever entries are added or removed
+        uint64_t files;      // Number of files in the cache dir as of the last eviction plus the files added since
+    };
+
+    const boost::filesystem::path _cache_dir;
+    const bool _readonly;
+    int _fd = -1;
+    Header *_header = nullptr;
+    size_t _mapped_size = 0;
+
+    // Process local index of the entries: (compilation hash, hash) => entry index
+    std::map<std::pair<uint64_t, uint64_t>, size_t> _index;
+    uint64_t _index_generation = 0;
+
+    // The lookups of this process not yet written to the manifest: (compilation hash, hash) => (last use, hits)
+    std::map<std::pair<uint64_t, uint64_t>, std::pair<int64_t, uint64_t> > _uses;
+
+    // Return a pointer to the entries
+    Entry *entries() {
+        return reinterpret_cast<Entry *>(_header + 1);
+    }
+
+    // Map the manifest file into memory again if its size has changed (must be called while locked).
+    // Returns false if the manifest cannot be used
+    bool remap();
+
+    // Initiate an empty manifest file with room for `capacity` entries (must be called while exclusively locked)
+    bool initiate(uint64_t capacity);
+
+    // Make sure that `_index` is up-to-date (must be called while locked)
+    void reindex();
+
+    // Write `_uses` to the manifest (must be called while exclusively locked)
+    void writeUses();
+
+public:
+    /** Open the manifest in `cache_dir`, which is created if it doesn't exist and `readonly` is false
+     *
+     * @param cache_dir The cache dir
+     * @param readonly  Whether the manifest should be left untouched
+     */
+    CacheManifest(boost::filesystem::path cache_dir, bool readonly);
+
+    ~CacheManifest();
+
+    CacheManifest(const CacheManifest &) = delete;
+
+    CacheManifest &operator=(const CacheManifest &) = delete;
+
+    // Return true if the manifest is usable
+    bool enabled() const {
+        return _header != nullptr;
+    }
+
+    /** Find the shared library of a kernel and register the lookup
+     *
+     * @param compilation_hash The hash of the compile command
+     * @param hash             The hash of the kernel source
+     * @param library          Output: the library hash
+     * @param symbol           Output: the symbol of the kernel function
+     * @return Whether the kernel was found
+     */
+    bool lookup(uint64_t compilation_hash, uint64_t hash, uint64_t &library, std::string &symbol);
+
+    /** Insert or update a kernel
+     *
+     * @param compilation_hash The hash of the compile command
+     * @param hash             The hash of the kernel source
+     * @param library          The library hash
+     * @param symbol           The symbol of the kernel function
+     * @param size             The size of the library in bytes
+     */
+    void insert(uint64_t compilation_hash, uint64_t hash, uint64_t library, const std::string &symbol,
+                uint64_t size);
+
+    /** Count the new files of the cache dir and when there are more than `max_files`, remove the least recently
+     *  used files of the cache dir (e.g. shared libraries and fuse cache files) and the kernels of the removed
+     *  libraries. A library is as recent as its most recently used kernel in the manifest. Other files, such as
+     *  libraries of older runs, are as recent as their last write time.
+     *
+     * @param max_files The maximum number of files to keep in the cache dir (excl. the manifest itself)
+     * @param new_files The number of files that this process added to the cache dir
+     */
+    void evict(uint64_t max_files, uint64_t new_files);
+
+    // Return the number of kernels in the manifest
+    uint64_t size();
+};
+
+} // jitk
+} // bohrium
@@ -20,18 +20,101 @@ If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <memory>
 #include <boost/filesystem.hpp>
 #include <bohrium/bh_config_parser.hpp>
 
 namespace bohrium {
 namespace jitk {
 
-/** Compiler that fork a process that compiles a shared library */
+/** Compiler that compiles a shared library within the process using the TinyCC library (libtcc),
+ *  which is loaded at runtime thus libtcc isn't a build dependency.
+ *  NB: TinyCC ignores `#pragma omp` thus `Compiler` never uses it for kernels that contain OpenMP pragmas. */
+class InProcessCompiler {
+private:
+    // The libtcc API (see libtcc.h)
+    typedef void *(*tcc_new_t)();
+    typedef void (*tcc_delete_t)(void *);
+    typedef int (*tcc_set_output_type_t)(void *, int);
+    typedef int (*tcc_add_include_path_t)(void *, const char *);
+    typedef void (*tcc_set_error_func_t)(void *, void *, void (*)(void *, const char *));
+    typedef int (*tcc_compile_string_t)(void *, const char *);
+    typedef int (*tcc_output_file_t)(void *, const char *);
+
+    void *_lib_handle = nullptr;
+    tcc_new_t _tcc_new;
+    tcc_delete_t _tcc_delete;
+    tcc_set_output_type_t _tcc_set_output_type;
+    tcc_add_include_path_t _tcc_add_include_path;
+    tcc_set_error_func_t _tcc_set_error_func;
+    tcc_compile_string_t _tcc_compile_string;
+    tcc_output_file_t _tcc_output_file;
+
+    // The value of `TCC_OUTPUT_DLL`, which differs between versions of libtcc (see `findOutputDll()`)
+    int _output_dll = -1;
+
+    // The include paths of the kernels
+    const std::vector<std::string> _include_paths;
+
+    // A compilation state of libtcc can only compile once, thus each thread that compiles keeps a configured
+    // state ready for its next kernel (key: the thread, value: the state)
+    std::map<std::thread::id, void *> _states;
+    // Protects `_states`
+    std::mutex _states_mutex;
+    // libtcc 0.9.27 isn't reentrant thus we only compile one kernel at a time with that version
+    bool _reentrant = false;
+    std::mutex _mutex;
+
+    // Return a new compilation state with the output type and include paths set or nullptr on failure
+    void *newState(int output_type);
+
+    // Take the prepared compilation state of the calling thread, which reports errors to `error`
+    // (nullptr on failure)
+    void *takeState(std::string &error);
+
+    // Prepare the compilation state that the calling thread takes next
+    void prepareState();
+
+    // Find the value of `TCC_OUTPUT_DLL` by compiling a library and check that it loads (throws on failure)
+    void findOutputDll();
+
+public:
+    /** Load libtcc
+     *
+     * @param library The name or path of the libtcc shared library
+     * @param include_paths The include paths of the kernels
+     */
+    InProcessCompiler(const std::string &library, std::vector<std::string> include_paths);
+
+    ~InProcessCompiler();
+
+    InProcessCompiler(const InProcessCompiler &) = delete;
+
+    InProcessCompiler &operator=(const InProcessCompiler &) = delete;
+
+    /** Compile source to a binary shared library
+     *
+     * @param output_file Path to the resulting output file
+     * @param source The source to compile
+     * @param error Output: the error messages of the compilation
+     * @return Whether the compilation succeeded
+     */
+    bool compile(const boost::filesystem::path &output_file, const std::string &source, std::string &error);
+};
+
+/** Compiler that fork a process that compiles a shared library or, when the backend is "libtcc",
+ *  compiles within the process and only fork a process when the in-process compilation fails. */
 class Compiler {
 public:
     std::string cmd_template;
     std::string config_path;
     bool verbose = false;
+    // The in-process compiler (nullptr when the backend is "subprocess")
+    std::shared_ptr<InProcessCompiler> in_process;
 
     /** Default constructor */
     Compiler() = default;
@@ -46,6 +129,27 @@ public:
                                                                                 config_path(std::move(config_path)),
                                                                                 verbose(verbose) {}
 
+    /** Constructor that takes:
+     *
+     * @param cmd_template Default command that expand {OUT} and {IN}
+     * @param config_path Path to the configuration file
+     * @param verbose Print the fully expanded compile command
+     * @param backend The compiler backend: "subprocess" or "libtcc"
+     * @param library The name or path of the libtcc shared library (only used by the "libtcc" backend)
+     */
+    Compiler(std::string cmd_template, std::string config_path, bool verbose, const std::string &backend,
+             const std::string &library);
+
+    /** Return true when `source` compiled using `command` is compiled by the in-process compiler, which ignores
+     *  OpenMP pragmas thus kernels with OpenMP constructs are always compiled by `command`
+     *
+     * @param source The source to compile
+     * @param command The compile command
+     */
+    bool inProcess(const std::string &source, const std::string &command) const {
+        return in_process and command == cmd_template and source.find("#pragma omp") == std::string::npos;
+    }
+
     /** Compile source to a binary shared library
      *
      * @param output_file Path to the resulting output file
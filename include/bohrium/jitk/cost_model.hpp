@@ -0,0 +1,109 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <atomic>
+
+#include <bohrium/jitk/block.hpp>
+#include <bohrium/bh_config_parser.hpp>
+
+namespace bohrium {
+namespace jitk {
+
+/** Model of the runtime of a kernel, which the fusers use to reject merges that are predicted to be slower
+ *  than executing the blocks as separate kernels.
+ *
+ *  The runtime of a kernel is a launch overhead plus the greater of its memory time (bytes moved to and from
+ *  non-temporary arrays) and its compute time (elements computed). Both are divided by the number of threads the
+ *  kernel can use, which is limited by its available threading. The compute time is scaled up when the kernel
+ *  accesses more arrays than the CPU has registers for.
+ */
+class CostModel {
+public:
+    // The properties of a kernel that the runtime is predicted from
+    struct Estimate {
+        // Bytes moved to and from non-temporary arrays
+        uint64_t bytes = 0;
+        // Number of elements computed by the non-system instructions
+        uint64_t work = 0;
+        // The amount of threading (see `parallel_ranks()`)
+        uint64_t threading = 0;
+        // Number of distinct arrays accessed
+        uint64_t num_arrays = 0;
+    };
+
+private:
+    // Kernel launch overhead in seconds
+    const double _kernel_overhead;
+    // Memory bandwidth of the whole machine and of a single thread in bytes per second
+    const double _bandwidth;
+    const double _thread_bandwidth;
+    // Elements computed per second by a single thread
+    const double _compute_rate;
+    // Number of threads available
+    const uint64_t _num_threads;
+    // Number of arrays a kernel can access before it spills registers
+    const uint64_t _num_registers;
+    // Calibrate the model using the measured runtime of the executed kernels
+    const bool _calibrate;
+    // Calibration from measured kernels: the sum of measured and predicted seconds excluding the launch overhead,
+    // which is protected by `_calibration_mutex`, and the resulting scale of the predictions
+    mutable std::mutex _calibration_mutex;
+    mutable double _measured = 0;
+    mutable double _predicted = 0;
+    mutable std::atomic<double> _scale{1};
+
+    // Returns the predicted seconds of `estimate` excluding the launch overhead and calibration
+    double _uncalibrated(const Estimate &estimate) const;
+
+public:
+    // The constructor reads the model parameters from `config`
+    explicit CostModel(const ConfigParser &config);
+
+    /** Returns the estimate of a block at the root level (i.e. a kernel) */
+    Estimate estimate(const Block &block) const;
+    Estimate estimate(const LoopB &kernel) const;
+
+    /** Returns the predicted runtime of a block at the root level in seconds */
+    double runtime(const Block &block) const;
+
+    /** Returns whether executing `merged` is predicted to be at least as fast as executing `b1` and `b2`
+     *  as separate kernels
+     */
+    bool profitable(const Block &b1, const Block &b2, const Block &merged) const;
+
+    /** Returns whether the model should be calibrated using the measured runtime of the executed kernels */
+    bool calibrating() const {
+        return _calibrate;
+    }
+
+    /** Calibrate the model using the measured runtime of `kernel`. Thread-safe.
+     *
+     *  NB: the calibration scales the memory and compute time of all predictions, thus it changes the balance
+     *      between them and the launch overhead. It only affects instruction lists fused after the calibration
+     *      and not found in the fuse cache.
+     */
+    void calibrate(const LoopB &kernel, std::chrono::duration<double> measured) const;
+};
+
+} // jit
+} // bohrium
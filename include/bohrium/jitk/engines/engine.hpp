@@ -51,6 +51,7 @@ protected:
     const bool strides_as_var;
     const bool index_as_var;
     const bool const_as_var;
+    const bool sizes_as_var;
     const bool use_volatile;
     const bool array_contraction;
 
@@ -86,12 +87,14 @@ public:
     Engine(component::ComponentVE &comp, Statistics &stat) :
             comp(comp),
             stat(stat),
-            fcache(stat),
+            fcache(stat, comp.config.defaultGet<boost::filesystem::path>("cache_dir", ""),
+                   comp.config.defaultGet<bool>("cache_readonly", false)),
             codegen_cache(stat),
             verbose(comp.config.defaultGet<bool>("verbose", false)),
             strides_as_var{comp.config.defaultGet<bool>("strides_as_var", true)},
             index_as_var{comp.config.defaultGet<bool>("index_as_var", true)},
             const_as_var{comp.config.defaultGet<bool>("const_as_var", true)},
+            sizes_as_var{comp.config.defaultGet<bool>("sizes_as_var", false)},
             use_volatile{comp.config.defaultGet<bool>("volatile", false)},
             array_contraction{comp.config.defaultGet<bool>("array_contraction", true)},
             cache_file_max(comp.config.defaultGet<int64_t>("cache_file_max", 50000)),
@@ -192,6 +195,18 @@ protected:
                                 const std::vector<uint64_t> &thread_stack,
                                 std::stringstream &out) = 0;
 
+    /** Write the code that follows a loop, which is written after the closing bracket of the loop
+     *
+     * @param symbols       The symbol table
+     * @param scope         The scope
+     * @param block         The block
+     * @param out           The stream output
+     */
+    virtual void loopTailWriter(const SymbolTable &symbols,
+                                Scope &scope,
+                                const LoopB &block,
+                                std::stringstream &out) {} // Default we do nothing
+
     /** Write the source code of an instruction
      *
      * @param scope     The scope
@@ -19,6 +19,8 @@ If not, see <http://www.gnu.org/licenses/>.
 */
 #pragma once
 
+#include <chrono>
+
 #include "engine.hpp"
 
 #include <bohrium/bh_config_parser.hpp>
@@ -37,8 +39,28 @@ class EngineCPU : public Engine {
 protected:
     // In order to avoid duplicate calls to `ConfigParser`, we store config settings here
     const FusionConfig fusion_config;
+    // Keep the trailing instructions of a flush unexecuted and fuse them with the next flush?
+    const bool lookahead;
+    // Deferred instructions are executed by the first flush after `lookahead_deadline` seconds.
+    // NB: the deadline is only checked when a flush arrives, there is no timer
+    const double lookahead_deadline;
+
+private:
+    // The instructions deferred by the lookahead (in program order)
+    std::vector<bh_instruction> _deferred;
+    // The time the oldest of the `_deferred` instructions was deferred
+    std::chrono::time_point<std::chrono::steady_clock> _deferred_since;
+
+    // Execute the instructions in `bhir`. When `allow_deferral` is true, the trailing instructions that neither
+    // access sync'ed nor freed arrays are moved to `_deferred` rather than executed.
+    void _handleExecution(BhIR *bhir, bool allow_deferral);
+
 public:
-    EngineCPU(component::ComponentVE &comp, Statistics &stat) : Engine(comp, stat), fusion_config(comp.config, false) {}
+    EngineCPU(component::ComponentVE &comp, Statistics &stat) :
+            Engine(comp, stat),
+            fusion_config(comp.config, false),
+            lookahead(comp.config.defaultGet<bool>("lookahead", false)),
+            lookahead_deadline(comp.config.defaultGet<double>("lookahead_deadline", 0.1)) {}
 
     ~EngineCPU() override = default;
 
@@ -48,13 +70,23 @@ public:
                              uint64_t codegen_hash,
                              std::stringstream &ss) = 0;
 
-    virtual void execute(const jitk::SymbolTable &symbols,
+    virtual void execute(const LoopB &kernel,
+                         const jitk::SymbolTable &symbols,
                          const std::string &source,
                          uint64_t codegen_hash,
                          const std::vector<const bh_instruction *> &constants) = 0;
 
+    // Compile the kernels in `sources` (pairs of source code and codegen hash) ahead of their execution, which makes
+    // it possible to compile them in parallel. The default implementation does nothing thus the kernels are compiled
+    // by `execute()` one by one.
+    virtual void compileAhead(const std::vector<std::pair<std::string, uint64_t> > &sources) {}
+
     void handleExecution(BhIR *bhir) override;
 
+    // Execute the instructions deferred by the lookahead, which must be done before the memory of an array is
+    // accessed outside of a flush and before the engine is destroyed
+    void flushLookahead();
+
     void handleExtmethod(BhIR *bhir) override;
 };
 
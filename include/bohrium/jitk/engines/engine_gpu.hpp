@@ -109,6 +109,7 @@ public:
         // NB: 'avoid_rank0_sweep' is set to true since GPUs cannot reduce over the outermost block
         for (const jitk::LoopB &kernel: get_kernel_list(instr_list, fusion_config, fcache, stat)) {
             // Let's create the symbol table for the kernel
+            // NB: the GPU engines write the loop sizes into the kernels thus `sizes_as_var` isn't supported
             const SymbolTable symbols(kernel,
                                       use_volatile,
                                       strides_as_var,
@@ -0,0 +1,183 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+namespace bohrium {
+namespace jitk {
+
+/** A persistent pool of threads that executes parallel loops.
+ *  The iteration space of a loop is split into chunks and each thread (including the calling thread) is
+ *  given a contiguous range of chunks. A thread that finishes its own range steals chunks from the others.
+ */
+class ExecutionPool {
+public:
+    // The body of a parallel loop, which executes the iterations [begin, end)
+    typedef std::function<void(uint64_t begin, uint64_t end)> LoopBody;
+
+private:
+    // The chunks assigned to a thread, which the owner and the thieves take one at a time from `next`
+    // NB: the padding reduces false sharing between the threads (C++11 `new` ignores over-alignment)
+    struct ChunkRange {
+        std::atomic<uint64_t> next{0};
+        uint64_t end = 0;
+        char padding[64 - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+    };
+
+    std::vector<std::thread> _workers;
+    // A chunk range per thread where the last one belongs to the calling thread
+    std::unique_ptr<ChunkRange[]> _ranges;
+
+    // The current loop
+    const LoopBody *_body = nullptr;
+    uint64_t _loop_size = 0;
+    uint64_t _chunk_size = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _cond_start;
+    std::condition_variable _cond_done;
+    // Incremented for each loop, which wakes up the workers
+    uint64_t _generation = 0;
+    // Number of workers still working on the current loop
+    size_t _running = 0;
+    bool _stop = false;
+
+    // Number of threads including the calling thread
+    size_t _numThreads() const {
+        return _workers.size() + 1;
+    }
+
+    // Execute the chunks of `_ranges[id]` and then steal chunks from the other threads
+    void _run(size_t id) {
+        const size_t num_threads = _numThreads();
+        for (size_t i = 0; i < num_threads; ++i) {
+            ChunkRange &range = _ranges[(id + i) % num_threads];
+            uint64_t chunk;
+            while ((chunk = range.next.fetch_add(1)) < range.end) {
+                const uint64_t begin = chunk * _chunk_size;
+                (*_body)(begin, std::min(begin + _chunk_size, _loop_size));
+            }
+        }
+    }
+
+    // The main loop of each worker thread
+    void _worker(size_t id) {
+        uint64_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond_start.wait(lock, [this, generation] { return _stop or _generation != generation; });
+                if (_stop) {
+                    return;
+                }
+                generation = _generation;
+            }
+            _run(id);
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (--_running == 0) {
+                    _cond_done.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    /** Construct a new pool
+     *
+     * @param num_threads The number of threads including the calling thread. Zero means one thread per
+     *                    hardware thread.
+     */
+    explicit ExecutionPool(unsigned int num_threads) {
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        _ranges.reset(new ChunkRange[num_threads]);
+        for (unsigned int i = 0; i + 1 < num_threads; ++i) {
+            _workers.emplace_back(&ExecutionPool::_worker, this, i);
+        }
+    }
+
+    ExecutionPool(const ExecutionPool &) = delete;
+
+    ExecutionPool &operator=(const ExecutionPool &) = delete;
+
+    ~ExecutionPool() {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cond_start.notify_all();
+        for (std::thread &t: _workers) {
+            t.join();
+        }
+    }
+
+    /** Execute the iterations [0, loop_size) of `body` in parallel and wait for them to finish
+     *
+     * @param loop_size The number of iterations
+     * @param body      The loop body, which is called with disjoint ranges of iterations.
+     *                  NB: it must not throw and the iterations must be independent
+     */
+    void parallelFor(uint64_t loop_size, const LoopBody &body) {
+        const size_t num_threads = _numThreads();
+        // Some more chunks than threads makes it possible to balance the load
+        const uint64_t num_chunks = std::min<uint64_t>(loop_size, num_threads * 4);
+        if (num_threads == 1 or num_chunks < 2) {
+            if (loop_size > 0) {
+                body(0, loop_size);
+            }
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _body = &body;
+            _loop_size = loop_size;
+            _chunk_size = (loop_size + num_chunks - 1) / num_chunks;
+            const uint64_t chunks_used = (loop_size + _chunk_size - 1) / _chunk_size;
+            for (size_t i = 0; i < num_threads; ++i) {
+                _ranges[i].next = chunks_used * i / num_threads;
+                _ranges[i].end = chunks_used * (i + 1) / num_threads;
+            }
+            _running = _workers.size();
+            ++_generation;
+        }
+        _cond_start.notify_all();
+        _run(num_threads - 1);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond_done.wait(lock, [this] { return _running == 0; });
+    }
+
+    /** Return the number of threads including the calling thread */
+    size_t size() const {
+        return _numThreads();
+    }
+};
+
+} // jitk
+} // bohrium
@@ -21,14 +21,20 @@ If not, see <http://www.gnu.org/licenses/>.
 
 #include <set>
 #include <vector>
+#include <memory>
 
 #include <bohrium/jitk/block.hpp>
+#include <bohrium/jitk/cost_model.hpp>
+#include <bohrium/jitk/execution_pool.hpp>
 #include <bohrium/bh_config_parser.hpp>
 #include <bohrium/bh_instruction.hpp>
 
 namespace bohrium {
 namespace jitk {
 
+// Returns the hash of the config settings that change the result of the fusion
+uint64_t fusion_settings_hash(const ConfigParser &config, bool avoid_rank0_sweep);
+
 /// In order to avoid duplicate calls to `ConfigParser`, we this struct
 struct FusionConfig {
     /// Will avoid fusion of sweeped and non-sweeped blocks at the root level
@@ -39,18 +45,45 @@ struct FusionConfig {
     std::string pre_fuser;
     /// List of fusers to use
     std::vector<std::string> fuser_list;
-    /// When using the greedy fuser, when exceeding `greedy_threshold` nodes fuser_reshapable_first() is used instead.
+    /// When using the greedy fuser, when exceeding `greedy_threshold` edges fuser_reshapable_first() is used instead.
     uint64_t greedy_threshold;
+    /// When using the optimal fuser, when exceeding `optimal_threshold` blocks the greedy fuser is used instead.
+    uint64_t optimal_threshold;
+    /// The maximum number of search nodes and seconds that the optimal fuser uses per block list
+    uint64_t optimal_max_nodes;
+    double optimal_max_time;
+    /// The number of elements per axis in a tile of the `tile` transformer (zero means fit the L1 cache)
+    uint64_t tile_size;
     /// Dump fusion graph
     bool graph;
+    /// The cost model of the `greedy_cost` fuser
+    CostModel cost_model;
+    /// Block lists of at least `parallel_threshold` blocks are split into independent components that are fused
+    /// in parallel by `pool` (nullptr when parallel fusion is disabled)
+    uint64_t parallel_threshold;
+    std::shared_ptr<ExecutionPool> pool;
+    /// Hash of the settings that change the fusion result, which identifies the result in the on-disk fuse cache
+    uint64_t settings_hash;
 
     FusionConfig(const ConfigParser &config, bool avoid_rank0_sweep) :
             avoid_rank0_sweep(avoid_rank0_sweep),
             monolithic(config.defaultGet<bool>("monolithic", false)),
             pre_fuser(config.defaultGet("pre_fuser", std::string("lossy"))),
             fuser_list(config.defaultGetList("fuser_list", {"greedy"})),
-            greedy_threshold(config.defaultGet<uint64_t>("greedy_threshold", 10000)),
-            graph(config.defaultGet<bool>("graph", false)) {}
+            greedy_threshold(config.defaultGet<uint64_t>("greedy_threshold", 1000000)),
+            optimal_threshold(config.defaultGet<uint64_t>("optimal_threshold", 64)),
+            optimal_max_nodes(config.defaultGet<uint64_t>("optimal_max_nodes", 100000)),
+            optimal_max_time(config.defaultGet<double>("optimal_max_time", 1.0)),
+            tile_size(config.defaultGet<uint64_t>("tile_size", 0)),
+            graph(config.defaultGet<bool>("graph", false)),
+            cost_model(config),
+            parallel_threshold(config.defaultGet<uint64_t>("fuser_parallel_threshold", 1000)),
+            settings_hash(fusion_settings_hash(config, avoid_rank0_sweep)) {
+        const unsigned int threads = config.defaultGet<unsigned int>("fuser_threads", 1);
+        if (threads != 1) {
+            pool = std::make_shared<ExecutionPool>(threads);
+        }
+    }
 };
 
 // Creates an instruction of 'InstrPtr' from an instruction list with all noop operations removed
@@ -76,7 +109,13 @@ void fuser_breadth_first(std::vector<Block> &block_list, bool avoid_rank0_sweep)
 void fuser_reshapable_first(std::vector<Block> &block_list, bool avoid_rank0_sweep);
 
 // Fuses 'block_list' greedily
-void fuser_greedy(const FusionConfig &config, std::vector<Block> &block_list);
+// When 'cost_model' isn't NULL, merges of root blocks that it predicts to be slower are rejected
+void fuser_greedy(const FusionConfig &config, std::vector<Block> &block_list,
+                  const CostModel *cost_model = nullptr);
+
+// Fuses 'block_list' optimally using a search bounded by time and number of search nodes.
+// Block lists longer than `config.optimal_threshold` are fused greedily
+void fuser_optimal(const FusionConfig &config, std::vector<Block> &block_list);
 
 } // jit
 } // bohrium
@@ -21,6 +21,7 @@ If not, see <http://www.gnu.org/licenses/>.
 
 #include <map>
 #include <vector>
+#include <boost/filesystem.hpp>
 
 #include <bohrium/bh_instruction.hpp>
 #include <bohrium/jitk/block.hpp>
@@ -39,17 +40,42 @@ private:
     };
     // The hash to payload map
     std::map<size_t, CachePayload> _cache;
+    // The directory of the on-disk cache, which is shared between runs (empty means no on-disk cache)
+    const boost::filesystem::path _cache_dir;
+    // Set to true, if no files should be written to `_cache_dir`
+    const bool _readonly;
+    // Number of files that this process added to `_cache_dir`
+    uint64_t _num_new_files = 0;
+
+    // Returns the path to the on-disk payload of `lookup_hash`
+    boost::filesystem::path _filePath(size_t lookup_hash, uint64_t settings_hash) const;
+    // Load the on-disk payload that matches 'instr_list' into `_cache`. Returns false when no valid file is found
+    bool _load(const std::vector<bh_instruction *> &instr_list, size_t lookup_hash, uint64_t settings_hash);
+    // Write the payload of `lookup_hash` to disk
+    void _store(const CachePayload &payload, size_t num_instrs, size_t lookup_hash, uint64_t settings_hash);
 public:
     // Some statistics
     jitk::Statistics &stat;
 
-    // The constructor takes the statistic object
-    FuseCache(jitk::Statistics &stat) : stat(stat) {}
+    /** The constructor takes the statistic object and the on-disk cache settings
+     *
+     * @param stat      The statistic object
+     * @param cache_dir The directory of the on-disk cache or the empty path to disable the on-disk cache
+     * @param readonly  Only read from the on-disk cache, which also leaves the last use of the files unchanged
+     */
+    FuseCache(jitk::Statistics &stat, boost::filesystem::path cache_dir, bool readonly) :
+            _cache_dir(std::move(cache_dir)), _readonly(readonly), stat(stat) {}
 
-    // Check the cache for a block list that matches 'instr_list'
-    std::pair<std::vector<Block>, bool> get(const std::vector<bh_instruction *> &instr_list);
+    // Check the cache for a block list that matches 'instr_list'.
+    // `settings_hash` identifies the fusion settings (see `FusionConfig::settings_hash`) in the on-disk cache
+    std::pair<std::vector<Block>, bool> get(const std::vector<bh_instruction *> &instr_list, uint64_t settings_hash);
     // Insert 'block_list' as a hit when requesting 'instr_list'
-    void insert(const std::vector<bh_instruction *> &instr_list, std::vector<Block> block_list);
+    void insert(const std::vector<bh_instruction *> &instr_list, std::vector<Block> block_list,
+                uint64_t settings_hash);
+    // Return the number of files that this process added to the on-disk cache
+    uint64_t numNewFiles() const {
+        return _num_new_files;
+    }
 };
 
 
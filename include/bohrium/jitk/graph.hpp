@@ -24,6 +24,7 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <string>
 
 #include <bohrium/jitk/block.hpp>
+#include <bohrium/jitk/cost_model.hpp>
 #include <bohrium/bh_instruction.hpp>
 
 #include <boost/graph/graph_traits.hpp>
@@ -133,9 +134,29 @@ std::vector<Block> topological(DAG &dag, bool avoid_rank0_sweep) {
     return ret;
 }
 
-// Merges the vertices in 'dag' greedily.
-// 'avoid_rank0_sweep' will avoid fusion of sweeped and non-sweeped blocks at the root level
-void greedy(DAG &dag, bool avoid_rank0_sweep);
+/* Merges the vertices in 'dag' greedily, i.e. repeatedly merges the fusible edge with the greatest weight.
+ * 'avoid_rank0_sweep' will avoid fusion of sweeped and non-sweeped blocks at the root level
+ *
+ * The fusible edges are kept in a priority queue where only the edges of a merged vertex are updated,
+ * and a topological order bounds the search for transitive paths.
+ *
+ * When 'cost_model' isn't NULL, merges that it predicts to be slower than the separate blocks are rejected
+ *
+ * Complexity: O(E * log(E)) plus the path searches, which are local for most DAGs
+ */
+void greedy(DAG &dag, bool avoid_rank0_sweep, const CostModel *cost_model = nullptr);
+
+/* Merges the vertices in 'dag' such that the total cost, i.e. the bytes moved to and from non-temporary arrays
+ * summed over all blocks, is minimal using a branch-and-bound search that starts from the greedy fusion of 'dag'.
+ * 'avoid_rank0_sweep' will avoid fusion of sweeped and non-sweeped blocks at the root level
+ * The search stops after 'max_nodes' search nodes or 'max_seconds' seconds, in which case 'dag' is the best fusion
+ * found so far (at least as good as the greedy fusion).
+ *
+ * Returns true when the search completed thus the fusion is optimal
+ *
+ * Complexity: O(2^E) search nodes in the worst case
+ */
+bool optimal(DAG &dag, bool avoid_rank0_sweep, uint64_t max_nodes, double max_seconds);
 
 } // graph
 } // jit
@@ -43,5 +43,15 @@ InstrPtr reshape_rank(const InstrPtr &instr, int rank, int64_t size_of_rank_dim)
 void write_operation(const bh_instruction &instr, const std::vector<std::string> &ops, std::stringstream &out,
                      bool opencl);
 
+/// Is the `instr` operation supported by `write_vector_operation()`?
+/// NB: it doesn't check the operands, which must be contiguous along the vectorized axis
+bool vector_operation_compatible(const bh_instruction &instr);
+
+/// Write the `instr` operation on GCC vector extension types given the vector operands in `ops` as strings.
+/// `vtype` is the vector type of the output and `mtype` is the signed integer vector type of the same size, which
+/// is the result of vector comparisons. The output of a reduction (`ops[0]`) is a vector of partial results.
+void write_vector_operation(const bh_instruction &instr, const std::vector<std::string> &ops,
+                            const std::string &vtype, const std::string &mtype, std::stringstream &out);
+
 } // jitk
 } // bohrium
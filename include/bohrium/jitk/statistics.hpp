@@ -26,6 +26,8 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <fstream>
 #include <iomanip>
 #include <vector>
+#include <map>
+#include <algorithm>
 
 #include <bohrium/colors.hpp>
 #include <bohrium/bh_ir.hpp>
@@ -51,6 +53,9 @@ struct KernelStats {
   std::chrono::duration<double> total_time{0};
   std::chrono::duration<double> max_time{0};
   std::chrono::duration<double> min_time{std::numeric_limits<double>::infinity()};
+  // The number of explicitly vectorized loops and innermost loops of the kernel
+  uint64_t num_simd_loops = 0;
+  uint64_t num_innermost_loops = 0;
 
   bool operator< (const KernelStats& rhs) const {
     // default ordering: by total time
@@ -65,6 +70,17 @@ struct KernelStats {
   }
 };
 
+struct OpcodeStats {
+  // The number of executed instructions of the opcode
+  uint64_t num_instrs = 0;
+  // The share of the kernel execution time of the instructions
+  std::chrono::duration<double> total_time{0};
+
+  bool operator< (const OpcodeStats& rhs) const {
+    return this->total_time.count() < rhs.total_time.count();
+  }
+};
+
 class Statistics {
   private:
     uint64_t max_num_kernels = 100;
@@ -80,14 +96,23 @@ class Statistics {
     uint64_t threading_below_threshold = 0;
     uint64_t fuser_cache_lookups       = 0;
     uint64_t fuser_cache_misses        = 0;
+    uint64_t fuser_cache_disk_hits     = 0;
     uint64_t codegen_cache_lookups     = 0;
     uint64_t codegen_cache_misses      = 0;
     uint64_t kernel_cache_lookups      = 0;
     uint64_t kernel_cache_misses       = 0;
+    uint64_t num_interpreted_kernels   = 0;
+    uint64_t num_pool_kernels          = 0;
+    uint64_t num_deferred_instrs       = 0;
     uint64_t num_instrs_into_fuser     = 0;
     uint64_t num_blocks_out_of_fuser   = 0;
+    uint64_t num_loop_interchanges     = 0;
+    uint64_t num_simd_loops            = 0;
+    uint64_t num_innermost_loops       = 0;
     uint64_t malloc_cache_lookups      = 0;
     uint64_t malloc_cache_misses       = 0;
+    // The malloc cache lookups and misses of each size class (key: size class in bytes)
+    std::map<uint64_t, std::pair<uint64_t, uint64_t> > malloc_cache_bins;
     std::chrono::duration<double> time_total_execution{0};
     std::chrono::duration<double> time_pre_fusion{0};
     std::chrono::duration<double> time_fusion{0};
@@ -102,6 +127,9 @@ class Statistics {
     // key: kernel source filename, value: kernel statistics
     std::map<std::string, KernelStats> time_per_kernel;
 
+    // key: opcode, value: the opcode's share of the kernel execution time
+    std::map<bh_opcode, OpcodeStats> time_per_opcode;
+
     std::chrono::duration<double> wallclock{0};
     std::chrono::time_point<std::chrono::steady_clock> time_started{std::chrono::steady_clock::now()};
 
@@ -129,11 +157,23 @@ class Statistics {
 
             out << BLU << "[" << backend_name << "] Profiling: \n" << RST;
             out << "Fuse cache hits:                 " << GRN << fuseCacheHits()                     << "\n" << RST;
+            out << "Fuse cache hits from disk:       " << GRN << fuseCacheDiskHits()                 << "\n" << RST;
             out << "Codegen cache hits:              " << GRN << codegenCacheHits()                  << "\n" << RST;
             out << "Compilation cache hits:          " << GRN << kernelCacheHits()                   << "\n" << RST;
             out << "Array contractions:              " << GRN << arrayContractions()                 << "\n" << RST;
             out << "Outer-fusion ratio:              " << GRN << outerFusionRatio()                  << "\n" << RST;
+            out << "Loop interchanges:               " << GRN << num_loop_interchanges               << "\n" << RST;
+            out << "Explicit SIMD loops:             " << GRN << simdLoops()                         << "\n" << RST;
             out << "Malloc cache hits:               " << GRN << MallocCacheHits()                   << "\n" << RST;
+            for (const auto &bin: malloc_cache_bins) {
+                stringstream name;
+                name << "  " << bin.first / 1024 << " KB bin:";
+                out << left << setw(33) << name.str() << right << GRN
+                    << pprint_ratio(bin.second.first - bin.second.second, bin.second.first) << "\n" << RST;
+            }
+            out << "Interpreted kernels:             " << GRN << num_interpreted_kernels             << "\n" << RST;
+            out << "Pool-executed kernels:           " << GRN << num_pool_kernels                    << "\n" << RST;
+            out << "Lookahead deferred instructions: " << GRN << num_deferred_instrs                 << "\n" << RST;
             out << "\n";
             out << "Max memory usage:                " << GRN << memoryUsage() << " MB"              << "\n" << RST;
             out << "Syncs to NumPy:                  " << GRN << num_syncs                           << "\n" << RST;
@@ -163,7 +203,8 @@ class Statistics {
                                        << std::setw(14) << "Calls"
                                        << std::setw(12) << "Total time"
                                        << std::setw(12) << "Max time"
-                                       << std::setw(12) << "Min time"                                << "\n" << RST;
+                                       << std::setw(12) << "Min time"
+                                       << std::setw(12) << "SIMD loops"                              << "\n" << RST;
               auto const topk_kernels = topkKernelTimes(max_num_kernels);
               for (auto const& x : topk_kernels) {
                 std::string kernel_filename = x.first;
@@ -174,12 +215,32 @@ class Statistics {
                     << std::scientific   << std::setprecision(2)
                                          << std::setw(8) << kernel_data.total_time.count() << "s   "
                                          << std::setw(8) << kernel_data.max_time.count()   << "s   "
-                                         << std::setw(8) << kernel_data.min_time.count()   << "s   " << "\n" << RST;
+                                         << std::setw(8) << kernel_data.min_time.count()   << "s   "
+                    << std::right        << std::setw(5) << kernel_data.num_simd_loops << "/"
+                    << std::left         << std::setw(5) << kernel_data.num_innermost_loops       << "\n" << RST;
               }
               const uint64_t num_omitted_kernels = time_per_kernel.size() - topk_kernels.size();
               if (num_omitted_kernels > 0) {
                   out << "  (" << num_omitted_kernels << " kernels omitted)\n";
               }
+
+              out << "\n";
+              out << BLU << "Per-opcode Profiling (kernel time split by the work of each instruction):" << "\n" << RST;
+              out << "  " << std::left << std::setw(39) << "Opcode"
+                                       << std::setw(14) << "Instructions"
+                                       << std::setw(12) << "Total time"                              << "\n" << RST;
+              std::vector<std::pair<bh_opcode, OpcodeStats> > opcodes(time_per_opcode.begin(), time_per_opcode.end());
+              std::sort(opcodes.begin(), opcodes.end(), [](const std::pair<bh_opcode, OpcodeStats> &a,
+                                                           const std::pair<bh_opcode, OpcodeStats> &b) {
+                  return b.second < a.second;
+              });
+              for (auto const& x : opcodes) {
+                out << "  "
+                    << std::left         << std::setw(39) << bh_opcode_text(x.first)
+                    << std::right << YEL << std::setw(10) << x.second.num_instrs    << "    "
+                    << std::scientific   << std::setprecision(2)
+                                         << std::setw(8) << x.second.total_time.count() << "s"     << "\n" << RST;
+              }
             }
             out << endl;
         } else {
@@ -219,10 +280,22 @@ class Statistics {
             file << "----"                                                           << "\n";
             file << backend_name << ":"                                              << "\n";
             file << "  fuse_cache_hits: "       << fuseCacheHits()                   << "\n";
+            file << "  fuse_cache_disk_hits: "  << fuseCacheDiskHits()               << "\n";
             file << "  codegen_cache_hits: "    << codegenCacheHits()                << "\n";
             file << "  kernel_cache_hits: "     << kernelCacheHits()                 << "\n";
             file << "  array_contractions: "    << arrayContractions()               << "\n";
             file << "  outer_fusion_ratio: "    << outerFusionRatio()                << "\n";
+            file << "  loop_interchanges: "     << num_loop_interchanges             << "\n";
+            file << "  simd_loops: "            << simdLoops()                       << "\n";
+            file << "  malloc_cache_hits: "     << MallocCacheHits()                 << "\n";
+            file << "  malloc_cache_bins:"                                           << "\n"; // hits by KB
+            for (const auto &bin: malloc_cache_bins) {
+                file << "    " << bin.first / 1024 << ": "
+                     << pprint_ratio(bin.second.first - bin.second.second, bin.second.first) << "\n";
+            }
+            file << "  interpreted_kernels: "   << num_interpreted_kernels           << "\n";
+            file << "  pool_kernels: "          << num_pool_kernels                  << "\n";
+            file << "  deferred_instrs: "       << num_deferred_instrs               << "\n";
             file << "  memory_usage: "          << memoryUsage()                     << "\n"; // mb
             file << "  syncs: "                 << num_syncs                         << "\n";
             file << "  total_work: "            << totalwork                         << "\n"; // ops
@@ -245,6 +318,14 @@ class Statistics {
                 file << "            total_time: " << kernel_data.total_time.count() << "\n"; // s
                 file << "            max_time: "   << kernel_data.max_time.count()   << "\n"; // s
                 file << "            min_time: "   << kernel_data.min_time.count()   << "\n"; // s
+                file << "            simd_loops: " << kernel_data.num_simd_loops     << "\n";
+                file << "            innermost_loops: " << kernel_data.num_innermost_loops << "\n";
+              }
+              file << "      per_opcode: "                                           << "\n";
+              for (auto const& x : time_per_opcode) {
+                file << "        - " << bh_opcode_text(x.first) << ": "              << "\n";
+                file << "            num_instrs: " << x.second.num_instrs            << "\n";
+                file << "            total_time: " << x.second.total_time.count()    << "\n"; // s
               }
             }
             file << "    copy2dev: "            << time_copy2dev.count()             << "\n"; // s
@@ -269,6 +350,30 @@ class Statistics {
         }
     }
 
+    // Record the execution time of 'kernel', which is split between the opcodes of its instructions proportionally
+    // to the number of elements each instruction computes
+    void record_opcode_time(const LoopB &kernel, const std::chrono::duration<double> &exec_time) {
+        if (not enabled) {
+            return;
+        }
+        std::vector<std::pair<bh_opcode, uint64_t> > work;
+        uint64_t total = 0;
+        for (const InstrPtr &instr: iterator::allInstr(kernel)) {
+            if (not bh_opcode_is_system(instr->opcode)) {
+                const uint64_t nelem = static_cast<uint64_t>(instr->shape().prod());
+                work.emplace_back(instr->opcode, nelem);
+                total += nelem;
+            }
+        }
+        for (const auto &w: work) {
+            OpcodeStats &opcode_stats = time_per_opcode[w.first];
+            ++opcode_stats.num_instrs;
+            if (total > 0) {
+                opcode_stats.total_time += exec_time * (static_cast<double>(w.second) / total);
+            }
+        }
+    }
+
     // Record statistics based on the 'symbols'
     void record(const SymbolTable& symbols) {
       num_base_arrays += symbols.getNumBaseArrays();
@@ -280,6 +385,10 @@ class Statistics {
         return pprint_ratio(fuser_cache_lookups - fuser_cache_misses, fuser_cache_lookups);
     }
 
+    std::string fuseCacheDiskHits() {
+        return pprint_ratio(fuser_cache_disk_hits, fuser_cache_lookups);
+    }
+
     std::string codegenCacheHits() {
         return pprint_ratio(codegen_cache_lookups - codegen_cache_misses, codegen_cache_lookups);
     }
@@ -288,6 +397,10 @@ class Statistics {
         return pprint_ratio(kernel_cache_lookups - kernel_cache_misses, kernel_cache_lookups);
     }
 
+    std::string simdLoops() {
+        return pprint_ratio(num_simd_loops, num_innermost_loops);
+    }
+
     std::string arrayContractions() {
         return pprint_ratio(num_temp_arrays, num_base_arrays);
     }
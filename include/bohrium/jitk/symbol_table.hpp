@@ -123,6 +123,8 @@ private:
     std::map<bh_view, size_t, OffsetAndStrides_less> _idx_map; // Mapping a index (of an array) to its ID
     std::map<bh_view, size_t, OffsetAndStrides_less> _offset_strides_map; // Mapping a offset-and-strides to its ID
     std::vector<const bh_view*> _offset_stride_views; // Vector of all offset-and-stride views
+    std::map<const LoopB*, size_t> _loop_size_map; // Mapping a loop to the ID of its size variable
+    std::vector<const LoopB*> _loop_size_blocks; // Vector of all loops with a size variable
     std::set<InstrPtr, Constant_less> _constant_set; // Set of instructions to a constant ID (Order by `origin_id`)
     std::set<bh_base*> _array_always; // Set of base arrays that should always be arrays
     std::vector<bh_base*> _params; // Vector of non-temporary arrays, which are the in-/out-puts of the JIT kernel
@@ -137,8 +139,11 @@ public:
     const bool index_as_var;
     // Should we use constants as variables?
     const bool const_as_var;
+    // Should we use the size of for-loops as variables?
+    const bool sizes_as_var;
 
-    SymbolTable(const LoopB &kernel, bool use_volatile, bool strides_as_var, bool index_as_var, bool const_as_var);
+    SymbolTable(const LoopB &kernel, bool use_volatile, bool strides_as_var, bool index_as_var, bool const_as_var,
+                bool sizes_as_var = false);
 
     // Get the ID of 'base', throws exception if 'base' doesn't exist
     size_t baseID(const bh_base *base) const {
@@ -170,6 +175,18 @@ public:
     const std::vector<const bh_view*> &offsetStrideViews() const {
         return _offset_stride_views;
     }
+    // Get the ID of the size variable of 'loop', throws exception if 'loop' doesn't exist
+    size_t loopSizeID(const LoopB &loop) const {
+        return _loop_size_map.at(&loop);
+    }
+    // Check if 'loop' has a size variable. NB: one-sized loops never have a size variable
+    bool existLoopSizeID(const LoopB &loop) const {
+        return _loop_size_map.find(&loop) != _loop_size_map.end();
+    }
+    // Get the loops with a size variable in the order of their IDs
+    const std::vector<const LoopB*> &loopSizeBlocks() const {
+        return _loop_size_blocks;
+    }
     // Get the set of constants
     const std::set<InstrPtr, Constant_less> &constIDs() const {
         return _constant_set;
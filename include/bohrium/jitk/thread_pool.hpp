@@ -0,0 +1,122 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <queue>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <condition_variable>
+
+namespace bohrium {
+namespace jitk {
+
+/** A fixed-size pool of worker threads that executes tasks in FIFO order.
+ *  Tasks still in the queue when the pool is destroyed are discarded; their futures
+ *  will throw `std::future_error` (broken promise) when accessed.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()> > _tasks;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _stop = false;
+
+    // The main loop of each worker thread
+    void _worker() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond.wait(lock, [this] { return _stop or not _tasks.empty(); });
+                if (_stop) {
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    /** Construct a new pool
+     *
+     * @param num_threads The number of worker threads. Zero means one thread per hardware thread.
+     */
+    explicit ThreadPool(unsigned int num_threads) {
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned int i = 0; i < num_threads; ++i) {
+            _workers.emplace_back(&ThreadPool::_worker, this);
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /** Stops the pool. Running tasks are finished and queued tasks are discarded */
+    ~ThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stop = true;
+            std::queue<std::function<void()> > empty;
+            std::swap(_tasks, empty);
+        }
+        _cond.notify_all();
+        for (std::thread &t: _workers) {
+            t.join();
+        }
+    }
+
+    /** Submit `func` for execution in the pool
+     *
+     * @param func The function to execute, which takes no arguments
+     * @return A future of the return value of `func`. Exceptions thrown by `func` are stored in the future
+     */
+    template<typename Func>
+    std::future<typename std::result_of<Func()>::type> submit(Func func) {
+        typedef typename std::result_of<Func()>::type ReturnT;
+        // NB: `std::function` must be copyable thus we wrap the packaged task in a shared pointer
+        auto task = std::make_shared<std::packaged_task<ReturnT()> >(std::move(func));
+        std::future<ReturnT> ret = task->get_future();
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _tasks.emplace([task]() { (*task)(); });
+        }
+        _cond.notify_one();
+        return ret;
+    }
+
+    /** Return the number of worker threads */
+    size_t size() const {
+        return _workers.size();
+    }
+};
+
+} // jitk
+} // bohrium
@@ -38,5 +38,18 @@ void split_for_threading(std::vector<Block> &block_list, uint64_t min_threading=
 // Collapses redundant axes within the 'block_list'
 void collapse_redundant_axes(std::vector<Block> &block_list);
 
+// Permutes the loops of perfectly nested blocks such that the innermost loop has the fewest non-contiguous array
+// accesses (e.g. when accessing transposed views). Sweeped loops are not moved.
+// Returns the number of interchanged blocks
+uint64_t loop_interchange(std::vector<Block> &block_list);
+
+// Returns the size of the L1 data cache in bytes (or 32KiB when unknown)
+uint64_t l1_cache_size();
+
+// Tiles the two innermost axes of perfectly nested parallel loops that access arrays non-contiguously
+// (e.g. transposes) such that each tile fits in the L1 cache.
+// 'tile_size' is the number of elements per axis in a tile, zero means the size is derived from the L1 cache size
+void tile(std::vector<Block> &block_list, uint64_t tile_size=0);
+
 } // jitk
 } // bohrium
@@ -0,0 +1,76 @@
+import util
+
+# The explicitly vectorized loops are followed by a scalar loop of the remaining iterations, thus the sizes are
+# chosen such that some aren't divisible by the vector lanes and some are smaller than a vector.
+CONFIGS = [{"compiler_explicit_simd": True},
+           {"compiler_explicit_simd": True, "compiler_simd_width": 16},
+           {"compiler_explicit_simd": True, "compiler_vector_convert": False}]
+SIZES = [1, 3, 8, 33, 1001]
+
+
+class test_explicit_simd:
+    def init(self):
+        for config in CONFIGS:
+            for size in SIZES:
+                for dtype in ["np.float64", "np.float32", "np.int32", "np.uint8"]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "a = R.random_of_dtype(shape=(%d,), dtype=%s, bohrium=BH); " % (size, dtype)
+                    cmd += "b = R.random_of_dtype(shape=(%d,), dtype=%s, bohrium=BH) + 1; " % (size, dtype)
+                    yield (cmd, config, dtype)
+
+    def test_elementwise(self, arg):
+        (cmd, config, dtype) = arg
+        return util.with_config(cmd + "res = M.maximum(a * b - a, b) + M.minimum(a, 3)", **config)
+
+    def test_reduce(self, arg):
+        (cmd, config, dtype) = arg
+        if dtype == "np.float32":  # The vectorized sum rounds differently, which float32 cannot hide
+            cmd += "a = a.astype(np.float64); "
+        ret = []
+        for op in ["add", "maximum", "minimum"]:
+            ret.append("M.%s.reduce(a).reshape(1)" % op)
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **config)
+
+
+class test_explicit_simd_mixed_types:
+    def init(self):
+        for config in CONFIGS:
+            for size in SIZES:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "a = R.random_of_dtype(shape=(%d,), dtype=np.int32, bohrium=BH); " % size
+                cmd += "f = R.random(shape=(%d,), bohrium=BH) * 100; " % size
+                yield (cmd, config)
+
+    def test_int_to_float(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = a.astype(np.float64) * 0.5 + f", **config)
+
+    def test_float_to_int(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = f.astype(np.int32) + a", **config)
+
+    def test_narrowing(self, arg):
+        (cmd, config) = arg
+        cmd += "res = (a % 50).astype(np.int8) + (f / 2).astype(np.float32).astype(np.int8)"
+        return util.with_config(cmd, **config)
+
+    def test_reduce_converted(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.add.reduce((a % 1000).astype(np.float64) + f).reshape(1)", **config)
+
+
+class test_explicit_simd_2d:
+    def init(self):
+        for config in CONFIGS:
+            for shape in [(5, 7), (3, 33), (9, 1)]:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape,)
+                yield (cmd, config)
+
+    def test_reduce_rows(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.add.reduce(a * 2, axis=1)", **config)
+
+    def test_views(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = a[:, ::-1] + a[::-1, :] * a", **config)
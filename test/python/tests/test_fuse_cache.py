@@ -0,0 +1,40 @@
+import util
+
+# The fuse cache writes the fusion of each flush to `cache_dir`, where the next process with the same fusion settings
+# loads it. The program runs three times in new processes that share a new cache dir: the first run fuses, the second
+# run loads the fuse files of the first run, and the third run changes a fusion setting thus it must fuse again.
+# Each run appends whether it loaded any fuse files to its results.
+CHANGED = {"greedy_threshold": 12345}
+
+# Sets `loaded` to 1 when a fuse file was loaded since the statistic was reset and otherwise 0
+LOADED = "import re; stat = bh.backend_messaging.statistic(); "
+LOADED += "hits = re.search(r'Fuse cache hits from disk:.*?(\\d+)/(\\d+)', stat); "
+LOADED += "loaded = int(int(hits.group(1)) > 0); "
+
+
+class test_fuse_cache:
+    def init(self):
+        for shape in [(1,), (5, 7), (3, 4, 5)]:
+            cmd = "R = bh.random.RandomState(42); "
+            cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape,)
+            yield cmd
+
+    def _three_runs(self, cmd):
+        """Returns the commands that run `cmd` without and with the fuse cache files of the previous runs"""
+        cmd_np = cmd + "; r = res.flatten(); res = M.concatenate([r, [0], r, [1], r, [0]])"
+        cmd_bh = "bh.backend_messaging.statistic_enable_and_reset(); " + cmd + "; bh.flush(); " + LOADED
+        cmd_bh += "res = M.concatenate([res.flatten(), M.array([loaded], dtype=res.dtype)])"
+        run = "util.run_with_config(%r, cache_dir=cache_dir" % cmd_bh
+        return (cmd_np, "import util, tempfile, shutil; cache_dir = tempfile.mkdtemp(); "
+                        "r1 = %s); r2 = %s); r3 = %s, **%r); shutil.rmtree(cache_dir); "
+                        "res = np.concatenate([r1, r2, r3])" % (run, run, run, CHANGED))
+
+    def test_elementwise(self, cmd):
+        return self._three_runs(cmd + "res = M.sqrt(a * 2 + 1) - a")
+
+    def test_reduce(self, cmd):
+        cmd += "b = a * a; res = M.concatenate([M.add.reduce(b, axis=0).flatten(), b.flatten()])"
+        return self._three_runs(cmd)
+
+    def test_across_flushes(self, cmd):
+        return self._three_runs(cmd + "b = a + 1; bh.flush(); c = b * b; bh.flush(); res = M.add.accumulate(c) + b")
@@ -0,0 +1,34 @@
+import util
+
+# The cost-model fuser, also without kernel launch overhead, and the optimal fuser must compute the same results as
+# the default fuser. The optimal fuser searches the small program to the end whereas it stops the search of the large
+# program at `optimal_max_nodes` and falls back to the best fusion found, which is then completed greedily.
+SMALL = "b = a * 2; c = b + a; res = M.add.reduce(c, axis=0)"
+LARGE = "b = a * 2; c = b.T + a; d = M.sqrt(c * c + 1); e = M.add.reduce(d, axis=1); f = M.maximum.reduce(d, axis=0); "
+LARGE += "g = M.add.accumulate(b, axis=0) - c; h = d[::-1] * b; "
+LARGE += "res = M.concatenate([e, f, g.flatten(), h.flatten(), (h + g).flatten()])"
+CONFIGS = [({"fuser_list": "greedy_cost, collapse_redundant_axes"}, [SMALL, LARGE]),
+           ({"fuser_list": "greedy_cost, collapse_redundant_axes", "cost_kernel_overhead": 0}, [SMALL, LARGE]),
+           ({"fuser_list": "optimal, collapse_redundant_axes"}, [SMALL]),
+           ({"fuser_list": "optimal, collapse_redundant_axes", "optimal_max_nodes": 3}, [LARGE])]
+
+
+class test_fuser:
+    def init(self):
+        for (config, programs) in CONFIGS:
+            for program in programs:
+                for shape in [(1, 1), (5, 5), (16, 16)]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape,)
+                    yield (cmd + program, config)
+
+    def test_fuser(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd, **config)
+
+    def test_same_as_default_fuser(self, arg):
+        # Both commands run Bohrium, thus the command must use `bh` rather than `M`
+        (cmd, config) = arg
+        cmd = cmd.replace("M.", "bh.").replace("BH", "True")
+        return ("import util; res = util.run_with_config(%r)" % cmd,
+                "import util; res = util.run_with_config(%r, **%r)" % (cmd, config))
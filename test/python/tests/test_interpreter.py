@@ -0,0 +1,116 @@
+import util
+
+# The OpenMP engine interprets all kernels that the interpreter supports, which must give the results of the
+# compiled kernels
+CONFIG = {"compiler_interpret_only": True}
+
+
+class test_elementwise:
+    def init(self):
+        for op in ["add", "subtract", "multiply", "maximum", "minimum", "greater", "less_equal", "equal",
+                   "not_equal", "logical_and", "logical_xor"]:
+            for dtype in ["np.float64", "np.int32", "np.uint8"]:
+                yield ("M.%s(a, b)" % op, dtype)
+        for op in ["floor_divide", "mod"]:
+            for dtype in ["np.float32", "np.int64"]:
+                yield ("M.%s(a, b)" % op, dtype)
+        yield ("M.power(a, b)", "np.float64")
+        for op in ["absolute", "sign"]:
+            for dtype in ["np.float64", "np.int16", "np.uint32"]:
+                yield ("M.%s(a - b)" % op, dtype)
+        yield ("M.absolute(a)", "np.bool")
+        yield ("M.logical_not(a)", "np.bool")
+        for op in ["bitwise_and", "bitwise_or", "bitwise_xor", "left_shift", "right_shift"]:
+            yield ("M.%s(a, b %% 8)" % op, "np.uint64")
+        yield ("M.invert(a)", "np.int8")
+        yield ("M.invert(a)", "np.bool")
+
+    def test_arrays(self, arg):
+        (op, dtype) = arg
+        cmd = "R = bh.random.RandomState(42); "
+        cmd += "a = R.random_of_dtype(shape=(7, 5), dtype=%s, bohrium=BH); " % dtype
+        cmd += "b = R.random_of_dtype(shape=(7, 5), dtype=%s, bohrium=BH) + 1; " % dtype
+        return util.with_config(cmd + "res = %s" % op, **CONFIG)
+
+    def test_views(self, arg):
+        (op, dtype) = arg
+        cmd = "R = bh.random.RandomState(42); "
+        cmd += "a = R.random_of_dtype(shape=(9, 8), dtype=%s, bohrium=BH)[1::2, ::-3]; " % dtype
+        cmd += "b = R.random_of_dtype(shape=(4, 3), dtype=%s, bohrium=BH) + 1; " % dtype
+        return util.with_config(cmd + "res = %s" % op, **CONFIG)
+
+
+class test_math:
+    def init(self):
+        for op in ["sin", "cos", "tan", "sinh", "cosh", "tanh", "arcsin", "arccos", "arctan", "arcsinh",
+                   "arctanh", "exp", "exp2", "expm1", "log", "log2", "log10", "log1p", "sqrt", "ceil", "trunc",
+                   "floor", "rint", "isnan", "isinf", "isfinite"]:
+            for dtype in ["np.float32", "np.float64"]:
+                yield (op, dtype)
+
+    def test_unary(self, arg):
+        (op, dtype) = arg
+        cmd = "R = bh.random.RandomState(42); "
+        cmd += "a = R.random(shape=(100,), bohrium=BH).astype(%s); " % dtype
+        return util.with_config(cmd + "res = M.%s(a)" % op, **CONFIG)
+
+
+class test_reduce:
+    def init(self):
+        for op in ["add", "multiply", "minimum", "maximum"]:
+            for dtype in ["np.float64", "np.int64", "np.uint16"]:
+                yield (op, dtype)
+        for op in ["logical_and", "logical_or", "logical_xor"]:
+            yield (op, "np.bool")
+        for op in ["bitwise_and", "bitwise_or", "bitwise_xor"]:
+            yield (op, "np.uint32")
+
+    def test_reduce(self, arg):
+        (op, dtype) = arg
+        cmd = "R = bh.random.RandomState(42); "
+        cmd += "a = R.random_of_dtype(shape=(6, 5, 4), dtype=%s, bohrium=BH); " % dtype
+        ret = []
+        for axis in range(3):
+            ret.append("M.%s.reduce(a, axis=%d).flatten()" % (op, axis))
+        ret.append("M.%s.reduce(a.flatten()).reshape(1)" % op)
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **CONFIG)
+
+
+class test_accumulate:
+    def init(self):
+        for op in ["add", "multiply"]:
+            for dtype in ["np.float64", "np.int64", "np.uint16"]:
+                yield (op, dtype)
+
+    def test_accumulate(self, arg):
+        (op, dtype) = arg
+        cmd = "R = bh.random.RandomState(42); "
+        cmd += "a = R.random_of_dtype(shape=(6, 5), dtype=%s, bohrium=BH) %% 3; " % dtype
+        ret = []
+        for axis in range(2):
+            ret.append("M.%s.accumulate(a, axis=%d).flatten()" % (op, axis))
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **CONFIG)
+
+
+class test_indexing:
+    def init(self):
+        for dtype in ["np.float64", "np.int32"]:
+            cmd = "R = bh.random.RandomState(42); "
+            cmd += "a = R.random_of_dtype(shape=(50,), dtype=%s, bohrium=BH); " % dtype
+            cmd += "ind = (R.random(shape=(20,), bohrium=BH) * 50).astype(np.int64); "
+            yield cmd
+
+    def test_gather(self, cmd):
+        return util.with_config(cmd + "res = M.take(a, ind)", **CONFIG)
+
+    def test_scatter(self, cmd):
+        return util.with_config(cmd + "M.put(a, M.arange(10, dtype=np.int64) * 3, ind[:10]); res = a", **CONFIG)
+
+    def test_cond_scatter(self, cmd):
+        cmd += "mask = M.arange(20) % 3 == 0; ind = M.arange(20, dtype=np.int64) * 2; "
+        np_cmd = cmd + "np.put(a, ind[mask], ind[mask]); res = a"
+        bh_cmd = cmd + "M.cond_scatter(a, ind, ind, mask); res = a"
+        return (np_cmd, util.with_config(bh_cmd, **CONFIG)[1])
+
+    def test_range(self, cmd):
+        return util.with_config(cmd + "res = M.arange(100, dtype=a.dtype)[::3] + a[:34]", **CONFIG)
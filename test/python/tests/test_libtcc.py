@@ -0,0 +1,40 @@
+import util
+import ctypes.util
+
+# The `libtcc` backend compiles the kernels without OpenMP constructs in-process and the other kernels using
+# `compiler_cmd`, which must give the same results. Without OpenMP, all kernels are compiled in-process.
+LIBTCC = ctypes.util.find_library("tcc")
+CONFIGS = [{"compiler_backend": "libtcc", "compiler_libtcc": LIBTCC},
+           {"compiler_backend": "libtcc", "compiler_libtcc": LIBTCC, "compiler_openmp": False,
+            "compiler_openmp_simd": False}]
+
+
+class _test_libtcc:
+    def init(self):
+        for config in CONFIGS:
+            for shape in [(1,), (17,), (5, 7)]:
+                for dtype in ["np.float64", "np.int32"]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "a = R.random_of_dtype(shape=%s, dtype=%s, bohrium=BH); " % (shape, dtype)
+                    cmd += "b = R.random_of_dtype(shape=%s, dtype=%s, bohrium=BH) + 1; " % (shape, dtype)
+                    yield (cmd, config)
+
+    def test_elementwise(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = (a % 100) * 2 + b * 3", **config)
+
+    def test_reduce(self, arg):
+        (cmd, config) = arg
+        cmd += "res = M.concatenate([M.add.reduce(a, axis=0).flatten(), M.maximum.reduce(b.flatten()).reshape(1)])"
+        return util.with_config(cmd, **config)
+
+    def test_accumulate(self, arg):
+        # Accumulations are sequential kernels, which aren't parallelized
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.add.accumulate(a.flatten())", **config)
+
+
+if LIBTCC is None:
+    print("libtcc not found, skipping the tests of the `libtcc` compiler backend")
+else:
+    test_libtcc = _test_libtcc
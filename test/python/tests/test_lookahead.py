@@ -0,0 +1,66 @@
+import util
+
+# The lookahead keeps the trailing instructions of a flush unexecuted and fuses them with the next flush. Deferred
+# instructions must see the same values as without the lookahead, also when the host syncs or frees arrays, when an
+# extension method executes in between, and when the deferred instructions are left at shutdown.
+# NB: `lookahead_deadline = 0` executes the deferred instructions at the next flush at the latest.
+CONFIGS = [{"lookahead": True}, {"lookahead": True, "lookahead_deadline": 0}]
+
+
+class test_lookahead:
+    def init(self):
+        for config in CONFIGS:
+            for size in [1, 17, 1000]:
+                yield ("a = M.arange(%d, dtype=np.float64); " % size, config)
+
+    def test_across_flushes(self, arg):
+        # The temporaries `b` and `c` are produced and consumed in different flushes
+        (cmd, config) = arg
+        cmd += "b = a * 2 + 1; bh.flush(); c = b * b; bh.flush(); d = M.add.reduce(c) + b; bh.flush(); "
+        cmd += "res = d - a"
+        return util.with_config(cmd, **config)
+
+    def test_same_as_without_lookahead(self, arg):
+        # Both commands run Bohrium, thus the command must use `bh` rather than `M`
+        (cmd, config) = arg
+        cmd = cmd.replace("M.", "bh.")
+        cmd += "b = a * 2 + 1; bh.flush(); c = b * b; bh.flush(); res = bh.add.accumulate(c) - b"
+        return ("import util; res = util.run_with_config(%r)" % cmd,
+                "import util; res = util.run_with_config(%r, **%r)" % (cmd, config))
+
+    def test_sync(self, arg):
+        # Reading `b` on the host executes the instructions deferred before it
+        (cmd, config) = arg
+        cmd += "b = a * 3; bh.flush(); s = float(b[-1]); c = b + s; bh.flush(); res = c * 2"
+        return util.with_config(cmd, **config)
+
+    def test_free(self, arg):
+        # The deferred instructions that access freed arrays are executed before the arrays are freed
+        (cmd, config) = arg
+        cmd += "b = a * 3; bh.flush(); c = b + 1; del b; bh.flush(); d = c * a; del a; bh.flush(); res = d + c"
+        return util.with_config(cmd, **config)
+
+    def test_shutdown(self, arg):
+        # The result is copied before `b` and `c` are computed, thus they are left deferred at shutdown
+        (cmd, config) = arg
+        cmd += "res = np.array(a * 2); b = a + 1; bh.flush(); c = b * b; bh.flush()"
+        return util.with_config(cmd, **config)
+
+
+class test_lookahead_extmethod:
+    def init(self):
+        for config in CONFIGS:
+            for n in [1, 4, 9]:
+                yield ("a = M.arange(%d, dtype=np.float64).reshape(%d, %d); " % (n * n, n, n), config)
+
+    def test_matmul(self, arg):
+        # The extension method executes the deferred instructions that produce its operands
+        (cmd, config) = arg
+        cmd += "b = a * 2; bh.flush(); c = M.matmul(b, a + 1); bh.flush(); res = c + b"
+        return util.with_config(cmd, **config)
+
+    def test_matmul_of_deferred_output(self, arg):
+        # The output of the extension method is the input of instructions that are deferred again
+        (cmd, config) = arg
+        cmd += "c = M.matmul(a, a); d = c * 2; bh.flush(); e = d + a; bh.flush(); res = M.matmul(e, d)"
+        return util.with_config(cmd, **config)
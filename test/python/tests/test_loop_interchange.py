@@ -0,0 +1,42 @@
+import util
+
+# The loop interchange moves the loop with the most contiguous accesses innermost, which must not change the
+# results. Sweeped loops are not moved.
+CONFIG = {"fuser_list": "greedy, loop_interchange, collapse_redundant_axes"}
+
+
+class test_loop_interchange:
+    def init(self):
+        for shape in [(37, 29), (64, 48), (2, 16), (3, 5, 7)]:
+            for dtype in ["np.float64", "np.int32"]:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "a = R.random_of_dtype(shape=%s, dtype=%s, bohrium=BH); " % (shape, dtype)
+                cmd += "b = R.random_of_dtype(shape=%s, dtype=%s, bohrium=BH); " % (shape, dtype)
+                yield (cmd, len(shape))
+
+    def test_transposed(self, arg):
+        (cmd, ndim) = arg
+        return util.with_config(cmd + "res = a.T + b.T", **CONFIG)
+
+    def test_transposed_chain(self, arg):
+        (cmd, ndim) = arg
+        return util.with_config(cmd + "t = a.T - b.T; res = t * a.T + t", **CONFIG)
+
+    def test_swept_reduce(self, arg):
+        (cmd, ndim) = arg
+        ret = []
+        for axis in range(ndim):
+            ret.append("M.add.reduce(a.T + b.T, axis=%d).flatten()" % axis)
+            ret.append("M.maximum.reduce(a.T * b.T, axis=%d).flatten()" % axis)
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **CONFIG)
+
+    def test_swept_accumulate(self, arg):
+        (cmd, ndim) = arg
+        ret = []
+        for axis in range(ndim):
+            ret.append("M.add.accumulate(a.T + b.T, axis=%d).flatten()" % axis)
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **CONFIG)
+
+    def test_strided(self, arg):
+        (cmd, ndim) = arg
+        return util.with_config(cmd + "res = a[::-1, 1::2].T + b[:, 1::2].T[::-1]", **CONFIG)
@@ -0,0 +1,110 @@
+import util
+
+# The reductions of an outer axis and the full reductions of the outermost loop are combined from thread-private
+# partials, which start at the identity of the reduction. The extents aren't divisible by the thread counts and
+# some are smaller than the number of threads. The outputs of more than `compiler_openmp_partials_max_elements`
+# elements are guarded by OpenMP atomic or critical instead.
+CONFIG = {"compiler_openmp_partials": True}
+NUM_THREADS = [1, 3, 16]
+SHAPES = [(2, 3), (5, 7), (17, 1), (1, 9), (33, 5)]
+
+
+def reductions(op, array, ndim=2):
+    """Returns the commands that reduce the `ndim`-dimensional `array` using `op` along each axis and in full"""
+    ret = []
+    for axis in range(ndim):
+        ret.append("M.%s.reduce(%s, axis=%d).flatten()" % (op, array, axis))
+    ret.append("M.%s.reduce(%s.flatten()).reshape(1)" % (op, array))
+    return ret
+
+
+def concatenate(reductions_list):
+    """Returns the command that concatenates the results of `reductions_list` into `res`"""
+    return "res = M.concatenate([%s])" % ", ".join(reductions_list)
+
+
+class test_parallel_reduction:
+    def init(self):
+        for num_threads in NUM_THREADS:
+            for shape in SHAPES:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "f = R.random(shape=%s, bohrium=BH); " % (shape,)
+                cmd += "i = R.random_of_dtype(shape=%s, dtype=np.int64, bohrium=BH); " % (shape,)
+                yield (cmd, num_threads)
+
+    def test_add(self, arg):
+        (cmd, num_threads) = arg
+        cmd += "a = f * 100 + (i % 1000); "
+        return util.with_config(cmd + concatenate(reductions("add", "a")), num_threads=num_threads, **CONFIG)
+
+    def test_multiply(self, arg):
+        (cmd, num_threads) = arg
+        cmd += "a = f / 100 + 0.995; "
+        return util.with_config(cmd + concatenate(reductions("multiply", "a")), num_threads=num_threads, **CONFIG)
+
+    def test_maximum_of_negatives(self, arg):
+        # The identity of maximum is the lowest value, not zero
+        (cmd, num_threads) = arg
+        cmd += "a = -f - 1; b = -(i % 1000) - 1; "
+        cmd += concatenate(reductions("maximum", "a") + reductions("maximum", "b"))
+        return util.with_config(cmd, num_threads=num_threads, **CONFIG)
+
+    def test_minimum_of_positives(self, arg):
+        # The identity of minimum is the highest value, not zero
+        (cmd, num_threads) = arg
+        cmd += "a = f + 1; b = (i % 1000) + 1; "
+        cmd += concatenate(reductions("minimum", "a") + reductions("minimum", "b"))
+        return util.with_config(cmd, num_threads=num_threads, **CONFIG)
+
+    def test_infinities(self, arg):
+        (cmd, num_threads) = arg
+        cmd += "a = f * 0 - np.inf; b = f * 0 + np.inf; "
+        cmd += concatenate(reductions("maximum", "a") + reductions("minimum", "b"))
+        return util.with_config(cmd, num_threads=num_threads, **CONFIG)
+
+    def test_bitwise(self, arg):
+        # The identity of bitwise-and has all bits set
+        (cmd, num_threads) = arg
+        cmd += "a = M.bitwise_or(i, -65536); "
+        ret = []
+        for op in ["bitwise_and", "bitwise_or", "bitwise_xor"]:
+            ret += reductions(op, "a")
+        return util.with_config(cmd + concatenate(ret), num_threads=num_threads, **CONFIG)
+
+    def test_logical(self, arg):
+        (cmd, num_threads) = arg
+        cmd += "a = f > 0.2; "
+        ret = []
+        for op in ["logical_and", "logical_or", "logical_xor"]:
+            ret += reductions(op, "a")
+        return util.with_config(cmd + concatenate(ret), num_threads=num_threads, **CONFIG)
+
+
+class test_parallel_reduction_nd:
+    def init(self):
+        # The partials of the outputs of 2-D and 3-D loops, which index the partial of each output element
+        for num_threads in [3, 16]:
+            for shape in [(2, 3, 4), (5, 1, 7), (3, 4, 2, 5), (17, 2, 3, 2)]:
+                for config in [CONFIG, dict(CONFIG, compiler_openmp_partials_max_elements=4)]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "f = R.random(shape=%s, bohrium=BH); " % (shape,)
+                    yield (cmd, num_threads, len(shape), config)
+
+    def test_maximum(self, arg):
+        (cmd, num_threads, ndim, config) = arg
+        cmd += "a = -f - 1; "
+        cmd += concatenate(reductions("maximum", "a", ndim))
+        return util.with_config(cmd, num_threads=num_threads, **config)
+
+    def test_transposed(self, arg):
+        # The reduced view isn't contiguous, thus the partials and the output are indexed differently
+        (cmd, num_threads, ndim, config) = arg
+        cmd += "a = (-f - 1).transpose(); b = (f + 1)[%s]; " % ", ".join(["::-1"] + [":"] * (ndim - 2) + ["::2"])
+        cmd += concatenate(reductions("maximum", "a", ndim) + reductions("minimum", "b", ndim))
+        return util.with_config(cmd, num_threads=num_threads, **config)
+
+    def test_multiply(self, arg):
+        (cmd, num_threads, ndim, config) = arg
+        cmd += "a = f / 100 + 0.995; "
+        cmd += concatenate(reductions("multiply", "a", ndim))
+        return util.with_config(cmd, num_threads=num_threads, **config)
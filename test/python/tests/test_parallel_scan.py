@@ -0,0 +1,52 @@
+import util
+
+# The parallel scan splits the accumulation of a one-dimensional loop into a chunk per thread, thus the sizes
+# aren't divisible by the thread counts and some are smaller than the number of threads.
+CONFIG = {"compiler_openmp_scan": True}
+NUM_THREADS = [1, 3, 16]
+SIZES = [1, 2, 5, 17, 1000, 1001]
+
+
+class test_parallel_scan:
+    def init(self):
+        for num_threads in NUM_THREADS:
+            for size in SIZES:
+                for dtype in ["np.float64", "np.int64", "np.int32"]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "a = R.random_of_dtype(shape=(%d,), dtype=%s, bohrium=BH) %% 100; " % (size, dtype)
+                    yield (cmd, num_threads, dtype)
+
+    def test_add(self, arg):
+        (cmd, num_threads, dtype) = arg
+        return util.with_config(cmd + "res = M.add.accumulate(a)", num_threads=num_threads, **CONFIG)
+
+    def test_multiply(self, arg):
+        # The products of +1 and -1 don't overflow
+        (cmd, num_threads, dtype) = arg
+        if dtype == "np.float64":
+            cmd += "a = a / 10000 + 0.995; "
+        else:
+            cmd += "a = (a % 2) * 2 - 1; "
+        return util.with_config(cmd + "res = M.multiply.accumulate(a)", num_threads=num_threads, **CONFIG)
+
+    def test_fused(self, arg):
+        (cmd, num_threads, dtype) = arg
+        return util.with_config(cmd + "res = M.add.accumulate(a * 2 + 1) - a", num_threads=num_threads, **CONFIG)
+
+
+class test_parallel_scan_2d:
+    def init(self):
+        # Only the accumulation of a one-dimensional loop is a parallel scan, the others must be unaffected
+        for num_threads in [3, 16]:
+            for shape in [(5, 7), (1, 33), (33, 1)]:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape,)
+                yield (cmd, num_threads)
+
+    def test_add(self, arg):
+        (cmd, num_threads) = arg
+        ret = []
+        for axis in range(2):
+            ret.append("M.add.accumulate(a, axis=%d).flatten()" % axis)
+        ret.append("M.add.accumulate(a.flatten())")
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), num_threads=num_threads, **CONFIG)
@@ -0,0 +1,37 @@
+import util
+
+# The gathers and scatters of innermost loops prefetch the element of the index `compiler_prefetch_distance`
+# iterations ahead, but not beyond the end of the loop, thus some sizes are smaller than the distance. The sorted
+# index check skips the prefetches of sorted indices.
+CONFIGS = [{"compiler_prefetch_distance": 1},
+           {"compiler_prefetch_distance": 16},
+           {"compiler_prefetch_distance": 16, "compiler_sorted_index_check": True}]
+SIZES = [1, 5, 17, 1000]
+
+
+class test_prefetch:
+    def init(self):
+        for config in CONFIGS:
+            for size in SIZES:
+                for index in ["random", "sorted"]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "a = R.random(shape=(%d,), bohrium=BH); " % size
+                    if index == "random":
+                        cmd += "ind = (R.random(shape=(%d,), bohrium=BH) * %d).astype(np.int64); " % (size, size)
+                    else:
+                        cmd += "ind = M.arange(%d, dtype=np.int64); " % size
+                    yield (cmd, config)
+
+    def test_gather(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.take(a, ind) * 2", **config)
+
+    def test_scatter(self, arg):
+        # NB: the random index might contain duplicates, thus the scattered values are the same for all elements
+        (cmd, config) = arg
+        return util.with_config(cmd + "M.put(a, ind, M.ones(ind.shape) * 3); res = a", **config)
+
+    def test_gather_2d(self, arg):
+        (cmd, config) = arg
+        cmd += "res = M.take(a, M.concatenate([ind, ind[::-1]]).reshape(2, ind.shape[0]))"
+        return util.with_config(cmd, **config)
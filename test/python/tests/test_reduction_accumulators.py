@@ -0,0 +1,74 @@
+import util
+
+# The innermost reductions that aren't vectorized accumulate into multiple scalars (or are summed pairwise),
+# followed by a loop of the remaining iterations, thus some sizes aren't divisible by the number of accumulators.
+CONFIGS = [{"compiler_openmp_simd": False},
+           {"compiler_openmp_simd": False, "compiler_reduction_accumulators": 3},
+           {"compiler_openmp_simd": False, "compiler_pairwise_sum": True},
+           {"compiler_openmp_simd": False, "compiler_openmp": False, "compiler_pairwise_sum": True}]
+SIZES = [1, 3, 8, 33, 1001]
+
+
+class test_reduction_accumulators:
+    def init(self):
+        for config in CONFIGS:
+            for size in SIZES:
+                for dtype in ["np.float64", "np.int32", "np.uint8"]:
+                    cmd = "R = bh.random.RandomState(42); "
+                    cmd += "a = R.random_of_dtype(shape=(%d,), dtype=%s, bohrium=BH); " % (size, dtype)
+                    cmd += "b = R.random_of_dtype(shape=(%d,), dtype=%s, bohrium=BH) + 1; " % (size, dtype)
+                    yield (cmd, config, dtype)
+
+    def test_reduce(self, arg):
+        (cmd, config, dtype) = arg
+        ret = []
+        for op in ["add", "maximum", "minimum"]:
+            ret.append("M.%s.reduce(a).reshape(1)" % op)
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **config)
+
+    def test_reduce_expression(self, arg):
+        (cmd, config, dtype) = arg
+        return util.with_config(cmd + "res = M.add.reduce(a * b - a).reshape(1)", **config)
+
+    def test_reduce_bitwise(self, arg):
+        (cmd, config, dtype) = arg
+        if dtype == "np.float64":
+            cmd += "a = a.astype(np.int64); "
+        ret = []
+        for op in ["bitwise_and", "bitwise_or", "bitwise_xor"]:
+            ret.append("M.%s.reduce(a).reshape(1)" % op)
+        return util.with_config(cmd + "res = M.concatenate([%s])" % ", ".join(ret), **config)
+
+
+class test_reduction_accumulators_2d:
+    def init(self):
+        for config in CONFIGS:
+            for shape in [(5, 7), (3, 33), (9, 1)]:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape,)
+                yield (cmd, config)
+
+    def test_reduce_rows(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.add.reduce(a * 2, axis=1)", **config)
+
+    def test_reduce_strided(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.maximum.reduce(a[::-1, ::2].T, axis=1)", **config)
+
+    def test_reduce_and_write(self, arg):
+        (cmd, config) = arg
+        cmd += "t = a * a; res = M.concatenate([M.add.reduce(t, axis=1), t.flatten()])"
+        return util.with_config(cmd, **config)
+
+
+class test_reduction_accumulators_large:
+    def init(self):
+        # Like `reduce_bench`, the sum of a constant spans many blocks of the pairwise sum
+        for config in CONFIGS + [{"compiler_explicit_simd": True, "compiler_pairwise_sum": True}]:
+            for size in [2 ** 20, 2 ** 20 + 7]:
+                yield ("a = M.ones(%d) * 0.1; " % size, config)
+
+    def test_sum(self, arg):
+        (cmd, config) = arg
+        return util.with_config(cmd + "res = M.add.reduce(a).reshape(1)", **config)
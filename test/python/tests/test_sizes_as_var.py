@@ -0,0 +1,41 @@
+import util
+
+# With `sizes_as_var`, the shape isn't part of the kernel, thus the kernel of the first shape is reused by the second
+# shape. The Bohrium command appends the number of codegen cache misses of the second shape to the results, which
+# must be zero like the NumPy command appends.
+CONFIG = {"sizes_as_var": True}
+SHAPES = [((5, 7), (9, 3)), ((1, 4), (33, 17)), ((16, 16), (2, 1))]
+
+# Sets `misses` to the number of codegen cache misses since the statistic was reset
+MISSES = "import re; hits = re.search(r'Codegen cache hits:.*?(\\d+)/(\\d+)', bh.backend_messaging.statistic()); "
+MISSES += "misses = int(hits.group(2)) - int(hits.group(1)); "
+
+
+class test_sizes_as_var:
+    def init(self):
+        for (shape1, shape2) in SHAPES:
+            cmd = "R = bh.random.RandomState(42); "
+            cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape1,)
+            cmd += "b = R.random(shape=%s, bohrium=BH); " % (shape2,)
+            yield cmd
+
+    def _two_shapes(self, cmd, func):
+        """Returns the commands that compute `func` of `a` and of `b`"""
+        cmd += "f = lambda x: %s; " % func
+        res = "res = M.concatenate([r1, r2, M.array([misses], dtype=r1.dtype)])"
+        cmd_np = cmd + "r1 = f(a).flatten(); r2 = f(b).flatten(); misses = 0; " + res
+        cmd_bh = cmd + "r1 = f(a).flatten(); bh.flush(); bh.backend_messaging.statistic_enable_and_reset(); "
+        cmd_bh += "r2 = f(b).flatten(); bh.flush(); " + MISSES + res
+        return (cmd_np, "import util; res = util.run_with_config(%r, **%r)" % (cmd_bh, CONFIG))
+
+    def test_elementwise(self, cmd):
+        return self._two_shapes(cmd, "x * 2 + M.sqrt(x)")
+
+    def test_reduce(self, cmd):
+        return self._two_shapes(cmd, "M.concatenate([M.add.reduce(x, axis=0), M.maximum.reduce(x * 3, axis=1)])")
+
+    def test_accumulate(self, cmd):
+        return self._two_shapes(cmd, "M.add.accumulate(x + 1, axis=1)")
+
+    def test_transposed(self, cmd):
+        return self._two_shapes(cmd, "x.T[::-1] * x.T")
@@ -0,0 +1,51 @@
+import util
+
+# Tiling splits the two innermost loops of kernels that access arrays non-contiguously, which must not change
+# the results
+FUSER_LIST = "greedy, tile, collapse_redundant_axes"
+
+
+class test_tile:
+    def init(self):
+        # The tile size 0 is derived from the L1 cache. The shapes are divisible by the tile extents, which
+        # might be smaller than the tile size, or have no tile extents (primes) thus they are not tiled.
+        for tile_size in [0, 4, 7]:
+            for shape in [(64, 48), (36, 20), (37, 29), (1, 16)]:
+                cmd = "R = bh.random.RandomState(42); "
+                cmd += "a = R.random(shape=%s, bohrium=BH); " % (shape,)
+                cmd += "b = R.random(shape=%s, bohrium=BH); " % (shape[::-1],)
+                yield (cmd, tile_size)
+
+    def test_transpose(self, arg):
+        (cmd, tile_size) = arg
+        return util.with_config(cmd + "res = a.T + b", fuser_list=FUSER_LIST, tile_size=tile_size)
+
+    def test_transpose_chain(self, arg):
+        (cmd, tile_size) = arg
+        cmd += "t = a.T * 2; res = M.sqrt(t) - b * t"
+        return util.with_config(cmd, fuser_list=FUSER_LIST, tile_size=tile_size)
+
+    def test_transpose_reduce(self, arg):
+        (cmd, tile_size) = arg
+        return util.with_config(cmd + "res = M.add.reduce(a.T + b, axis=1)", fuser_list=FUSER_LIST, tile_size=tile_size)
+
+    def test_strided(self, arg):
+        (cmd, tile_size) = arg
+        return util.with_config(cmd + "res = a[::-1, ::2].T * b[::2, ::-1]", fuser_list=FUSER_LIST, tile_size=tile_size)
+
+
+class test_tile_3d:
+    def init(self):
+        for tile_size in [0, 4]:
+            cmd = "R = bh.random.RandomState(42); "
+            cmd += "a = R.random(shape=(3, 16, 24), bohrium=BH); "
+            yield (cmd, tile_size)
+
+    def test_swap_inner(self, arg):
+        (cmd, tile_size) = arg
+        return util.with_config(cmd + "res = a.transpose(0, 2, 1) + 1", fuser_list=FUSER_LIST, tile_size=tile_size)
+
+    def test_swap_outer(self, arg):
+        (cmd, tile_size) = arg
+        cmd += "res = a.transpose(2, 1, 0) * a.transpose(2, 1, 0)"
+        return util.with_config(cmd, fuser_list=FUSER_LIST, tile_size=tile_size)
@@ -155,3 +155,37 @@ def add_bh107_cmd(func):
                 cmd.replace("bh.random.RandomState", "bh107.random.RandomState").replace(", bohrium=BH", ""))
 
     return inner
+
+
+def with_config(cmd, **options):
+    """Returns the NumPy command and the Bohrium command that runs `cmd` using `run_with_config()`, thus the test
+       compares `cmd` with the OpenMP config `options` against NumPy.
+       NB: the options are environment variables of the OpenMP stack, which other stacks ignore"""
+    return (cmd, "import util; res = util.run_with_config(%r, **%r)" % (cmd, options))
+
+
+def run_with_config(cmd, num_threads=None, **options):
+    """Runs the Bohrium command `cmd`, which must assign its result to `res`, in a new Python process where
+       the OpenMP config `options` are set through environment variables and returns `res` as a NumPy array.
+       `num_threads` sets the number of OpenMP threads of the process.
+       This is for testing code paths that the runtime chooses when it starts"""
+    import os
+    import sys
+    import subprocess
+    import tempfile
+
+    env = dict(os.environ)
+    for key, value in options.items():
+        env["BH_OPENMP_%s" % key.upper()] = str(value)
+    if num_threads is not None:
+        env["OMP_NUM_THREADS"] = str(num_threads)
+
+    (fd, filename) = tempfile.mkstemp(suffix=".npy")
+    os.close(fd)
+    try:
+        script = "import numpy as np\nimport bohrium as bh\n%s\n" % cmd
+        script += "np.save(%r, np.asarray(res.copy2numpy() if bh.check(res) else res))\n" % filename
+        subprocess.check_call([sys.executable, "-c", script], env=env)
+        return np.load(filename)
+    finally:
+        os.remove(filename)
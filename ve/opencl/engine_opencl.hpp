@@ -176,6 +176,9 @@ public:
     void updateFinalStatistics() override {
         stat.malloc_cache_lookups = malloc_cache.getTotalNumLookups();
         stat.malloc_cache_misses = malloc_cache.getTotalNumMisses();
+        for (const auto &bin: malloc_cache.getBinStats()) {
+            stat.malloc_cache_bins[bin.first] = std::make_pair(bin.second.lookups, bin.second.misses);
+        }
     }
 
     // Handle user kernels
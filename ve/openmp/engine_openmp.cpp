@@ -23,6 +23,7 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <fstream>
 #include <string>
 #include <map>
+#include <set>
 #include <iomanip>
 #include <dlfcn.h>
 #include <bohrium/jitk/codegen_util.hpp>
@@ -30,11 +31,16 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <bohrium/jitk/fuser_cache.hpp>
 #include <bohrium/jitk/codegen_cache.hpp>
 #include <bohrium/jitk/block.hpp>
+#include <bohrium/jitk/instruction.hpp>
+#include <bohrium/jitk/view.hpp>
 #include <thread>
+#include <algorithm>
 
 #include <bohrium/bh_util.hpp>
 #include "engine_openmp.hpp"
 #include "openmp_util.hpp"
+#include "interpreter.hpp"
+#include "numa.hpp"
 
 using namespace std;
 using namespace bohrium::jitk;
@@ -43,12 +49,54 @@ namespace fs = boost::filesystem;
 namespace bohrium {
 
 EngineOpenMP::EngineOpenMP(component::ComponentVE &comp, jitk::Statistics &stat) : EngineCPU(comp, stat), compiler(
-        comp.config.get<string>("compiler_cmd"), comp.config.file_dir.string(), verbose), compiler_openmp(
+        comp.config.get<string>("compiler_cmd"), comp.config.file_dir.string(), verbose,
+        comp.config.defaultGet<string>("compiler_backend", "subprocess"),
+        comp.config.defaultGet<string>("compiler_libtcc", "libtcc.so")), compiler_openmp(
         comp.config.defaultGet<bool>("compiler_openmp", false)), compiler_openmp_simd(
-        comp.config.defaultGet<bool>("compiler_openmp_simd", false)) {
-
+        comp.config.defaultGet<bool>("compiler_openmp_simd", false)), compiler_openmp_scan(
+        comp.config.defaultGet<bool>("compiler_openmp_scan", false)), compiler_openmp_partials(
+        comp.config.defaultGet<bool>("compiler_openmp_partials", false)), compiler_openmp_partials_max_elements(
+        comp.config.defaultGet<int64_t>("compiler_openmp_partials_max_elements", 65536)), compiler_explicit_simd(
+        comp.config.defaultGet<bool>("compiler_explicit_simd", false)), compiler_vector_convert(
+        comp.config.defaultGet<bool>("compiler_vector_convert", false)), compiler_simd_width(
+        comp.config.defaultGet<int64_t>("compiler_simd_width", 32)), compiler_reduction_accumulators(
+        comp.config.defaultGet<int64_t>("compiler_reduction_accumulators", 4)), compiler_pairwise_sum(
+        comp.config.defaultGet<bool>("compiler_pairwise_sum", false)), compiler_prefetch_distance(
+        comp.config.defaultGet<int64_t>("compiler_prefetch_distance", 0)), compiler_sorted_index_check(
+        comp.config.defaultGet<bool>("compiler_sorted_index_check", false)), compiler_async(
+        comp.config.defaultGet<bool>("compiler_async", false)), compiler_interpret_only(
+        comp.config.defaultGet<bool>("compiler_interpret_only", false)), compiler_batch(
+        comp.config.defaultGet<bool>("compiler_batch", false)), execution_pool(
+        comp.config.defaultGet<bool>("execution_pool", false)), numa_policy(
+        comp.config.defaultGet<string>("numa_policy", "none")), kernel_trace(
+        comp.config.defaultGet<boost::filesystem::path>("kernel_trace", "")) {
+
+    // NB: the kernels compiled in-process are told apart by their hash (see `sourceHash()`)
     compilation_hash = util::hash(compiler.cmd_template);
 
+    if (compiler_simd_width < 2 or (compiler_simd_width & (compiler_simd_width - 1)) != 0) {
+        throw std::runtime_error("config: `compiler_simd_width` must be a power of two");
+    }
+    if (compiler_reduction_accumulators < 1) {
+        throw std::runtime_error("config: `compiler_reduction_accumulators` must be positive");
+    }
+    if (compiler_prefetch_distance < 0) {
+        throw std::runtime_error("config: `compiler_prefetch_distance` must not be negative");
+    }
+    if (compiler_openmp_partials_max_elements < 0) {
+        throw std::runtime_error("config: `compiler_openmp_partials_max_elements` must not be negative");
+    }
+
+    _compile_pool.reset(new jitk::ThreadPool(comp.config.defaultGet<unsigned int>("compiler_threads", 0)));
+
+    if (execution_pool) {
+        _execution_pool.reset(new jitk::ExecutionPool(comp.config.defaultGet<unsigned int>("execution_threads", 0)));
+    }
+
+    if (not cache_bin_dir.empty()) {
+        _manifest.reset(new jitk::CacheManifest(cache_bin_dir, cache_readonly));
+    }
+
     // Initiate cache limits
     malloc_cache_limit_in_percent = comp.config.defaultGet<int64_t>("malloc_cache_limit", 80);
     if (malloc_cache_limit_in_percent < 0 or malloc_cache_limit_in_percent > 100) {
@@ -65,19 +113,54 @@ EngineOpenMP::EngineOpenMP(component::ComponentVE &comp, jitk::Statistics &stat)
                                                                       (malloc_cache_limit_in_percent / 100.0)));
     }
     bh_set_malloc_cache_limit(static_cast<uint64_t>(malloc_cache_limit_in_bytes));
+    bh_set_main_memory_hugepage(comp.config.defaultGet<bool>("malloc_hugepage", true));
+
+    // Let's control the NUMA placement of new arrays and pin the threads that execute the kernels
+    if (numa_policy != "none" and numa_policy != "first_touch" and numa_policy != "interleave") {
+        throw std::runtime_error("config: `numa_policy` must be `none`, `first_touch`, or `interleave`");
+    }
+    if (numa_policy != "none") {
+        _numa_node_mask = numa::node_mask();
+        bh_set_main_memory_hook([this](void *mem, uint64_t nbytes) { numaPlacement(mem, nbytes); });
+    }
+    const string numa_pinning = comp.config.defaultGet<string>("numa_pinning", "none");
+    if (numa_pinning != "none") {
+        numaPinning(numa_pinning);
+    }
+
+    // Let's get the kernels of the last run ready before the first flush
+    prewarm();
 }
 
 EngineOpenMP::~EngineOpenMP() {
     const bool use_cache = not (cache_readonly or cache_bin_dir.empty());
 
-    // Move JIT kernels to the cache dir
+    // Arrays allocated after the engine is gone are placed by the OS
+    if (numa_policy != "none") {
+        bh_set_main_memory_hook(nullptr);
+    }
+
+    // Let's finish the running background compilations and discard the queued ones
+    _compile_pool.reset();
+
+    // Move JIT kernels to the cache dir and register them in the manifest
+    // NB: libraries that failed or never finished compiling don't exist
+    uint64_t num_new_files = fcache.numNewFiles();
     if (use_cache) {
         try {
-            for (const auto &kernel: _functions) {
-                const fs::path src = tmp_bin_dir / jitk::hash_filename(compilation_hash, kernel.first, ".so");
+            for (const auto &library: _new_libraries) {
+                const string filename = jitk::hash_filename(compilation_hash, library.first, ".so");
+                const fs::path src = tmp_bin_dir / filename;
                 if (fs::exists(src)) {
-                    const fs::path dst = cache_bin_dir / jitk::hash_filename(compilation_hash, kernel.first, ".so");
+                    const fs::path dst = cache_bin_dir / filename;
+                    if (not fs::exists(dst)) {
+                        ++num_new_files;
+                    }
                     fs::copy_file(src, dst, fs::copy_option::overwrite_if_exists);
+                    const uint64_t size = fs::file_size(dst);
+                    for (const auto &kernel: library.second) {
+                        _manifest->insert(compilation_hash, kernel.first, library.first, kernel.second, size);
+                    }
                 }
             }
         } catch (const boost::filesystem::filesystem_error &e) {
@@ -86,13 +169,17 @@ EngineOpenMP::~EngineOpenMP() {
         }
     }
 
+    if (not kernel_trace.empty()) {
+        writeTrace();
+    }
+
     // File clean up
     if (not verbose) {
         fs::remove_all(tmp_src_dir);
     }
 
     if (cache_file_max != -1 and use_cache) {
-        util::remove_old_files(cache_bin_dir, cache_file_max);
+        _manifest->evict(static_cast<uint64_t>(cache_file_max), num_new_files);
     }
 
     // If this cleanup is enabled, the application segfaults
@@ -119,8 +206,211 @@ EngineOpenMP::~EngineOpenMP() {
     // }
 }
 
+void EngineOpenMP::prewarm() {
+    if (kernel_trace.empty()) {
+        return;
+    }
+    std::ifstream file(kernel_trace.string(), std::ios::binary);
+    uint64_t hash, size;
+    string symbol;
+    // Each kernel is written as "<hash> <symbol> <source size>\n<source>\n"
+    while (file >> hash >> symbol >> size and file.get() == '\n') {
+        string source(size, '\0');
+        if (not file.read(&source[0], size)) {
+            break;
+        }
+        if (_functions.find(hash) != _functions.end() or _pending.find(hash) != _pending.end()) {
+            continue;
+        }
+        const fs::path binfile = cachedLibrary(hash);
+        void *lib_handle = binfile.empty() ? nullptr : dlopen(binfile.string().c_str(), RTLD_NOW);
+        if (lib_handle != nullptr) {
+            try {
+                loadFunction(hash, lib_handle, symbol);
+            } catch (const std::runtime_error &e) {
+                _functions.erase(hash); // We simply compile the kernel again when it is needed
+            }
+        } else {
+            auto job = _compile_pool->submit([this, hash, source]() { return compileFunction(hash, source, ""); });
+            _pending.insert(make_pair(hash, job.share()));
+            _new_libraries[hash] = {make_pair(hash, symbol)};
+        }
+    }
+}
+
+void EngineOpenMP::numaPlacement(void *mem, uint64_t nbytes) {
+    // Regions smaller than this aren't worth a parallel first-touch
+    constexpr uint64_t first_touch_min_bytes = 1024 * 1024;
+
+    if (_numa_first_touch) {
+        if (nbytes < first_touch_min_bytes) {
+            return; // Small regions are left to the OS, which places each page at the node that touches it first
+        }
+        if (_numa_touch_func == nullptr) {
+            // The pages are distributed between the threads like the iterations of `#pragma omp parallel for`
+            stringstream ss;
+            ss << "#include <stdint.h>\n\n";
+            ss << "void numa_first_touch(void* data_list[], uint64_t args[], void *constants) {\n";
+            ss << "    char *mem = data_list[0];\n";
+            ss << "    const uint64_t nbytes = args[0], page_size = args[1];\n";
+            ss << "    #pragma omp parallel for schedule(static)\n";
+            ss << "    for(uint64_t i = 0; i < (nbytes + page_size - 1) / page_size; ++i) {\n";
+            ss << "        mem[i * page_size] = 0;\n";
+            ss << "    }\n";
+            ss << "}\n";
+            _numa_touch_func = getFunction(ss.str(), "numa_first_touch");
+        }
+        void *data_list[] = {mem};
+        uint64_t args[] = {nbytes, static_cast<uint64_t>(sysconf(_SC_PAGESIZE))};
+        _numa_touch_func(data_list, args, nullptr);
+    } else {
+        // Without a parallel first-touch, we spread the pages evenly between the nodes
+        numa::interleave(mem, nbytes, _numa_node_mask);
+    }
+}
+
+void EngineOpenMP::numaPinning(const string &pinning) {
+    if (not compiler_openmp) {
+        return; // Without OpenMP, the kernels are executed by the main thread alone
+    }
+    const vector<int> cpus = numa::pinning_order(pinning);
+    if (cpus.empty()) {
+        return;
+    }
+    // Since the OpenMP runtime reuses its threads, we pin them once in a parallel region of our own
+    stringstream ss;
+    ss << "#define _GNU_SOURCE\n";
+    ss << "#include <stdint.h>\n";
+    ss << "#include <sched.h>\n";
+    ss << "#include <omp.h>\n\n";
+    ss << "void numa_pin_threads(void* data_list[], uint64_t cpus[], void *constants) {\n";
+    ss << "    #pragma omp parallel\n";
+    ss << "    {\n";
+    ss << "        cpu_set_t cpu_set;\n";
+    ss << "        CPU_ZERO(&cpu_set);\n";
+    ss << "        CPU_SET(cpus[1 + omp_get_thread_num() % cpus[0]], &cpu_set);\n";
+    ss << "        sched_setaffinity(0, sizeof(cpu_set), &cpu_set);\n";
+    ss << "    }\n";
+    ss << "}\n";
+    KernelFunction pin_func = getFunction(ss.str(), "numa_pin_threads");
+
+    // The first element is the number of CPUs
+    vector<uint64_t> args(1, cpus.size());
+    args.insert(args.end(), cpus.begin(), cpus.end());
+    pin_func(nullptr, args.data(), nullptr);
+}
+
+void EngineOpenMP::updateFinalStatistics() {
+    bh_get_malloc_cache_stat(stat.malloc_cache_lookups, stat.malloc_cache_misses, stat.max_memory_usage);
+    for (const auto &bin: bh_get_malloc_cache_bin_stat()) {
+        stat.malloc_cache_bins[bin.first] = make_pair(bin.second.lookups, bin.second.misses);
+    }
+}
+
+void EngineOpenMP::writeTrace() const {
+    // We write to a tmp file and rename it, which makes the write atomic
+    const fs::path tmp_file = kernel_trace.string() + ".tmp";
+    try {
+        {
+            std::ofstream file(tmp_file.string(), std::ios::binary);
+            for (const auto &kernel: _trace) {
+                file << kernel.first << " " << kernel.second.first << " " << kernel.second.second.size() << "\n";
+                file << kernel.second.second << "\n";
+            }
+        }
+        fs::rename(tmp_file, kernel_trace);
+    } catch (const boost::filesystem::filesystem_error &e) {
+        cout << "Warning: couldn't write the kernel trace to " << kernel_trace << ". " << e.what() << endl;
+    }
+}
+
+uint64_t EngineOpenMP::sourceHash(const string &source, const string &compile_cmd) const {
+    if (compiler.inProcess(source, compile_cmd.empty() ? compiler.cmd_template : compile_cmd)) {
+        return util::hash(source + "libtcc");
+    }
+    return util::hash(source);
+}
+
+fs::path EngineOpenMP::cachedLibrary(uint64_t hash) {
+    uint64_t library;
+    string symbol;
+    if (_manifest and _manifest->lookup(compilation_hash, hash, library, symbol)) {
+        return cache_bin_dir / jitk::hash_filename(compilation_hash, library, ".so");
+    }
+    return fs::path();
+}
+
+fs::path EngineOpenMP::compileFunction(uint64_t hash, const string &source, const string &compile_cmd) const {
+    // We create the binary file in the tmp dir
+    const fs::path binfile = tmp_bin_dir / jitk::hash_filename(compilation_hash, hash, ".so");
+
+    // Write the source file and compile it (reading from disk)
+    // NB: this is a nice debug option, but will hurt performance
+    if (verbose) {
+        std::string source_filename = jitk::hash_filename(compilation_hash, hash, ".c");
+        fs::path srcfile = jitk::write_source2file(source, tmp_src_dir, source_filename, true);
+        if (compile_cmd.empty()) {
+            compiler.compile(binfile, srcfile);
+        } else {
+            compiler.compile(binfile, srcfile, compile_cmd);
+        }
+    } else {
+        // Pipe the source directly into the compiler thus no source file is written
+        if (compile_cmd.empty()) {
+            compiler.compile(binfile, source);
+        } else {
+            compiler.compile(binfile, source, compile_cmd);
+        }
+    }
+    return binfile;
+}
+
+KernelFunction EngineOpenMP::loadFunction(uint64_t hash, void *lib_handle, const string &func_name) {
+    _lib_handles.push_back(lib_handle);
+
+    // Load the launcher function
+    // The (clumsy) cast conforms with the ISO C standard and will
+    // avoid any compiler warnings.
+    dlerror(); // Reset errors
+    *(void **) (&_functions[hash]) = dlsym(lib_handle, func_name.c_str());
+    const char *dlsym_error = dlerror();
+    if (dlsym_error != nullptr) {
+        cerr << "Cannot load function launcher(): " << dlsym_error << endl;
+        throw runtime_error("VE-OPENMP: Cannot load function launcher()");
+    }
+
+    // Chunked kernels also have a chunked launcher function
+    if (execution_pool) {
+        ChunkFunction chunk_func;
+        *(void **) (&chunk_func) = dlsym(lib_handle, (func_name + "_chunk").c_str());
+        if (dlerror() == nullptr and chunk_func != nullptr) {
+            _chunk_functions[hash] = chunk_func;
+        }
+    }
+    return _functions.at(hash);
+}
+
+KernelFunction EngineOpenMP::loadPendingFunction(uint64_t hash, const string &func_name) {
+    auto pending = _pending.find(hash);
+    assert(pending != _pending.end());
+    // NB: `get()` waits for the compilation and re-throws its exceptions
+    const fs::path binfile = pending->second.get();
+    _pending.erase(pending);
+
+    void *lib_handle = dlopen(binfile.string().c_str(), RTLD_NOW);
+    if (lib_handle == nullptr) {
+        cerr << "Cannot load library: " << dlerror() << endl;
+        throw runtime_error("VE-OPENMP: Cannot load library");
+    }
+    return loadFunction(hash, lib_handle, func_name);
+}
+
 KernelFunction EngineOpenMP::getFunction(const string &source, const string &func_name, const string &compile_cmd) {
-    uint64_t hash = util::hash(source);
+    return getFunction(sourceHash(source, compile_cmd), source, func_name, compile_cmd);
+}
+
+KernelFunction EngineOpenMP::getFunction(uint64_t hash, const string &source, const string &func_name,
+                                         const string &compile_cmd) {
     ++stat.kernel_cache_lookups;
 
     // Do we have the function compiled and ready already?
@@ -128,37 +418,22 @@ KernelFunction EngineOpenMP::getFunction(const string &source, const string &fun
         return _functions.at(hash);
     }
 
+    // Is the function being compiled in the background already?
+    if (_pending.find(hash) != _pending.end()) {
+        return loadPendingFunction(hash, func_name);
+    }
+
     // The path to the shared library file.
-    fs::path binfile = cache_bin_dir / jitk::hash_filename(compilation_hash, hash, ".so");
-    
+    fs::path binfile = cachedLibrary(hash);
+
     // Let's try to load the shared library. If it fails for any reason, we try again after a compilation.
-    void *lib_handle = dlopen(binfile.string().c_str(), RTLD_NOW);
+    void *lib_handle = binfile.empty() ? nullptr : dlopen(binfile.string().c_str(), RTLD_NOW);
 
     // If the binary file couldn't load, we compile it.
     if (verbose or cache_bin_dir.empty() or lib_handle == nullptr) {
         ++stat.kernel_cache_misses;
-
-        // We create the binary file in the tmp dir
-        binfile = tmp_bin_dir / jitk::hash_filename(compilation_hash, hash, ".so");
-
-        // Write the source file and compile it (reading from disk)
-        // NB: this is a nice debug option, but will hurt performance
-        if (verbose) {
-            std::string source_filename = jitk::hash_filename(compilation_hash, hash, ".c");
-            fs::path srcfile = jitk::write_source2file(source, tmp_src_dir, source_filename, true);
-            if (compile_cmd.empty()) {
-                compiler.compile(binfile, srcfile);
-            } else {
-                compiler.compile(binfile, srcfile, compile_cmd);
-            }
-        } else {
-            // Pipe the source directly into the compiler thus no source file is written
-            if (compile_cmd.empty()) {
-                compiler.compile(binfile, source);
-            } else {
-                compiler.compile(binfile, source, compile_cmd);
-            }
-        }
+        binfile = compileFunction(hash, source, compile_cmd);
+        _new_libraries[hash] = {make_pair(hash, func_name)};
     }
 
     // If the library wasn't loaded before compilation, we try one more time
@@ -169,82 +444,245 @@ KernelFunction EngineOpenMP::getFunction(const string &source, const string &fun
             throw runtime_error("VE-OPENMP: Cannot load library");
         }
     }
-    _lib_handles.push_back(lib_handle);
+    return loadFunction(hash, lib_handle, func_name);
+}
 
-    // Load the launcher function
-    // The (clumsy) cast conforms with the ISO C standard and will
-    // avoid any compiler warnings.
-    dlerror(); // Reset errors
-    *(void **) (&_functions[hash]) = dlsym(lib_handle, func_name.c_str());
-    const char *dlsym_error = dlerror();
-    if (dlsym_error != nullptr) {
-        cerr << "Cannot load function launcher(): " << dlsym_error << endl;
-        throw runtime_error("VE-OPENMP: Cannot load function launcher()");
+void EngineOpenMP::compileAhead(const vector<pair<string, uint64_t> > &sources) {
+    auto tbuild = chrono::steady_clock::now();
+
+    // Let's find the kernels that we have to compile (pairs of source hash and index into `sources`)
+    vector<pair<uint64_t, size_t> > new_kernels;
+    set<uint64_t> new_hashes;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const uint64_t hash = sourceHash(sources[i].first);
+        if (_functions.find(hash) != _functions.end() or _pending.find(hash) != _pending.end() or
+            not new_hashes.insert(hash).second) {
+            continue;
+        }
+        // Kernels in the cache dir are loaded by `execute()`
+        if (not verbose and not cachedLibrary(hash).empty()) {
+            continue;
+        }
+        new_kernels.push_back(make_pair(hash, i));
     }
-    return _functions.at(hash);
+
+    // Without background compilation, a single kernel is simply compiled by `execute()`
+    if (not compiler_async and new_kernels.size() < 2) {
+        return;
+    }
+    stat.kernel_cache_misses += new_kernels.size();
+
+    if (compiler_batch and new_kernels.size() > 1) {
+        // We combine all kernels into one translation unit, which is compiled into one shared library
+        stringstream ss;
+        for (const auto &kernel: new_kernels) {
+            ss << sources[kernel.second].first << "\n";
+        }
+        const string batch_source = ss.str();
+        const uint64_t batch_hash = sourceHash(batch_source);
+        auto job = _compile_pool->submit([this, batch_hash, batch_source]() {
+            return compileFunction(batch_hash, batch_source, "");
+        }).share();
+
+        vector<pair<uint64_t, string> > &batch = _new_libraries[batch_hash];
+        for (const auto &kernel: new_kernels) {
+            _pending.insert(make_pair(kernel.first, job));
+            stringstream symbol;
+            symbol << "launcher_" << sources[kernel.second].second;
+            batch.push_back(make_pair(kernel.first, symbol.str()));
+        }
+    } else {
+        for (const auto &kernel: new_kernels) {
+            const uint64_t hash = kernel.first;
+            const string &source = sources[kernel.second].first;
+            auto job = _compile_pool->submit([this, hash, source]() { return compileFunction(hash, source, ""); });
+            _pending.insert(make_pair(hash, job.share()));
+            stringstream symbol;
+            symbol << "launcher_" << sources[kernel.second].second;
+            _new_libraries[hash] = {make_pair(hash, symbol.str())};
+        }
+    }
+    stat.time_compile += chrono::steady_clock::now() - tbuild;
 }
 
+KernelFunction EngineOpenMP::getFunctionAsync(uint64_t hash, const string &source, const string &func_name) {
+    ++stat.kernel_cache_lookups;
 
-void EngineOpenMP::execute(const jitk::SymbolTable &symbols,
+    // Do we have the function compiled and ready already?
+    if (_functions.find(hash) != _functions.end()) {
+        return _functions.at(hash);
+    }
+
+    auto pending = _pending.find(hash);
+    if (pending == _pending.end()) {
+        // Let's try to load the shared library from the cache before compiling in the background
+        const fs::path binfile = cachedLibrary(hash);
+        if (not (verbose or binfile.empty())) {
+            void *lib_handle = dlopen(binfile.string().c_str(), RTLD_NOW);
+            if (lib_handle != nullptr) {
+                return loadFunction(hash, lib_handle, func_name);
+            }
+        }
+        ++stat.kernel_cache_misses;
+        auto job = _compile_pool->submit([this, hash, source]() { return compileFunction(hash, source, ""); });
+        pending = _pending.insert(make_pair(hash, job.share())).first;
+        _new_libraries[hash] = {make_pair(hash, func_name)};
+    }
+
+    // Is the background compilation finished?
+    if (pending->second.wait_for(chrono::seconds(0)) != future_status::ready) {
+        return nullptr;
+    }
+    return loadPendingFunction(hash, func_name);
+}
+
+
+void EngineOpenMP::registerExecTime(const LaunchDescriptor &launch, chrono::steady_clock::duration texec) {
+    jitk::KernelStats &kernel_stats = stat.time_per_kernel[launch.stats_key];
+    kernel_stats.num_simd_loops = launch.num_simd_loops;
+    kernel_stats.num_innermost_loops = launch.num_innermost_loops;
+    kernel_stats.register_exec_time(texec);
+}
+
+void EngineOpenMP::execute(const jitk::LoopB &kernel,
+                           const jitk::SymbolTable &symbols,
                            const std::string &source,
                            uint64_t codegen_hash,
                            const std::vector<const bh_instruction *> &constants) {
-    // Notice, we use a "pure" hash of `source` to make sure that the `source_filename` always
-    // corresponds to `source` even if `codegen_hash` is buggy.
-    uint64_t hash = util::hash(source);
-    std::string source_filename = jitk::hash_filename(compilation_hash, hash, ".c");
+    // Let's find the launch descriptor of the kernel, which we create on the first launch
+    auto launch_it = _launches.find(codegen_hash);
+    if (launch_it == _launches.end()) {
+        LaunchDescriptor launch;
+        // Notice, we use a "pure" hash of `source` to make sure that the `source_filename` always
+        // corresponds to `source` even if `codegen_hash` is buggy.
+        launch.hash = sourceHash(source);
+        launch.stats_key = jitk::hash_filename(compilation_hash, launch.hash, ".c");
+        auto simd_it = _simd_loops.find(codegen_hash);
+        if (simd_it != _simd_loops.end()) {
+            launch.num_simd_loops = simd_it->second.first;
+            launch.num_innermost_loops = simd_it->second.second;
+        }
+        stringstream t;
+        t << "launcher_" << codegen_hash;
+        launch.func_name = t.str();
+        if (execution_pool) {
+            launch.chunkable = chunkableLoop(kernel) != nullptr;
+        }
+        // Kernels executed by the execution pool don't follow the OpenMP partitioning
+        if (numa_policy == "first_touch" and compiler_openmp and not launch.chunkable) {
+            for (const Block &b: kernel._block_list) {
+                if (not b.isInstr() and b.getLoop().size > 1 and openmp_compatible(b.getLoop())) {
+                    launch.first_touch = true;
+                }
+            }
+        }
+        if (not kernel_trace.empty() and _trace.find(launch.hash) == _trace.end()) {
+            _trace[launch.hash] = make_pair(launch.func_name, source);
+        }
+        launch_it = _launches.insert(make_pair(codegen_hash, std::move(launch))).first;
+    }
+    LaunchDescriptor &launch = launch_it->second;
 
     // Make sure all arrays are allocated
+    // NB: new memory of a parallel kernel is first-touched by the threads that will execute the kernel
+    _numa_first_touch = launch.first_touch;
     for (bh_base *base: symbols.getParams()) {
         bh_data_malloc(base);
     }
+    _numa_first_touch = false;
 
     // Compile the kernel
-    auto tbuild = chrono::steady_clock::now();
-    string func_name;
-    {
-        stringstream t;
-        t << "launcher_" << codegen_hash;
-        func_name = t.str();
+    if (launch.func == nullptr) {
+        auto tbuild = chrono::steady_clock::now();
+        if (compiler_interpret_only and interpreter::supported(kernel)) {
+            // Leaving `launch.func` unset makes us interpret the kernel
+        } else if (compiler_async) {
+            launch.func = getFunctionAsync(launch.hash, source, launch.func_name);
+            // If the kernel isn't ready and we cannot interpret it, we have to wait for the compilation
+            if (launch.func == nullptr and not interpreter::supported(kernel)) {
+                launch.func = loadPendingFunction(launch.hash, launch.func_name);
+            }
+        } else {
+            launch.func = getFunction(launch.hash, source, launch.func_name);
+            assert(launch.func != nullptr);
+        }
+        stat.time_compile += chrono::steady_clock::now() - tbuild;
+        if (launch.func != nullptr and launch.chunkable) {
+            auto chunk_it = _chunk_functions.find(launch.hash);
+            if (chunk_it != _chunk_functions.end()) {
+                launch.chunk_func = chunk_it->second;
+            }
+        }
+    } else {
+        ++stat.kernel_cache_lookups;
     }
-    KernelFunction func = getFunction(source, func_name);
-    assert(func != nullptr);
-    stat.time_compile += chrono::steady_clock::now() - tbuild;
 
-    // Create a 'data_list' of data pointers
-    vector<void *> data_list;
-    data_list.reserve(symbols.getParams().size());
-    for (bh_base *base: symbols.getParams()) {
+    // While the kernel is being compiled in the background, we interpret it
+    if (launch.func == nullptr) {
+        auto start_exec = chrono::steady_clock::now();
+        interpreter::execute(kernel);
+        auto texec = chrono::steady_clock::now() - start_exec;
+        stat.time_exec += texec;
+        registerExecTime(launch, texec);
+        stat.record_opcode_time(kernel, texec);
+        ++stat.num_interpreted_kernels;
+        return;
+    }
+
+    // Patch the 'data_list' of data pointers
+    // NB: the argument buffers of the launch descriptor only allocate on the first launch
+    launch.data_list.resize(symbols.getParams().size());
+    for (size_t i = 0; i < symbols.getParams().size(); ++i) {
+        bh_base *base = symbols.getParams()[i];
         assert(base->getDataPtr() != nullptr);
-        data_list.push_back(base->getDataPtr());
+        launch.data_list[i] = base->getDataPtr();
     }
 
     // And the offset-and-strides
-    vector<uint64_t> offset_and_strides;
-    offset_and_strides.reserve(symbols.offsetStrideViews().size());
+    size_t count = 0;
+    for (const bh_view *view: symbols.offsetStrideViews()) {
+        count += 1 + view->ndim;
+    }
+    launch.offset_and_strides.resize(count);
+    count = 0;
     for (const bh_view *view: symbols.offsetStrideViews()) {
-        const uint64_t t = (uint64_t) view->start;
-        offset_and_strides.push_back(t);
+        launch.offset_and_strides[count++] = (uint64_t) view->start;
         for (int i = 0; i < view->ndim; ++i) {
-            const uint64_t s = (uint64_t) view->stride[i];
-            offset_and_strides.push_back(s);
+            launch.offset_and_strides[count++] = (uint64_t) view->stride[i];
         }
     }
+    // And the loop sizes, which follows the offset-and-strides
+    for (const LoopB *loop: symbols.loopSizeBlocks()) {
+        launch.offset_and_strides.push_back(static_cast<uint64_t>(loop->size));
+    }
 
     // And the constants
-    vector<bh_constant_value> constant_arg;
-    constant_arg.reserve(constants.size());
-    for (const bh_instruction *instr: constants) {
-        constant_arg.push_back(instr->constant.value);
+    launch.constant_arg.resize(constants.size());
+    for (size_t i = 0; i < constants.size(); ++i) {
+        launch.constant_arg[i] = constants[i]->constant.value;
     }
 
     auto start_exec = chrono::steady_clock::now();
-    // Call the launcher function, which will execute the kernel
-    func(&data_list[0], &offset_and_strides[0], &constant_arg[0]);
+    if (launch.chunk_func != nullptr) {
+        // Let the execution pool call the chunked launcher function, which will execute a chunk of the kernel
+        const ChunkFunction chunk_func = launch.chunk_func;
+        void **data_list = launch.data_list.data();
+        uint64_t *offset_and_strides = launch.offset_and_strides.data();
+        bh_constant_value *constant_arg = launch.constant_arg.data();
+        // NB: the size of the loop might differ between launches when `sizes_as_var` is enabled
+        const uint64_t chunk_loop_size = static_cast<uint64_t>(chunkableLoop(kernel)->size);
+        _execution_pool->parallelFor(chunk_loop_size, [=](uint64_t begin, uint64_t end) {
+            chunk_func(data_list, offset_and_strides, constant_arg, begin, end);
+        });
+        ++stat.num_pool_kernels;
+    } else {
+        // Call the launcher function, which will execute the kernel
+        launch.func(launch.data_list.data(), launch.offset_and_strides.data(), launch.constant_arg.data());
+    }
     auto texec = chrono::steady_clock::now() - start_exec;
     stat.time_exec += texec;
-    stat.time_per_kernel[source_filename].register_exec_time(texec);
-
+    registerExecTime(launch, texec);
+    stat.record_opcode_time(kernel, texec);
 }
 
 // Writes the OpenMP specific for-loop header
@@ -253,21 +691,729 @@ void EngineOpenMP::loopHeadWriter(const jitk::SymbolTable &symbols,
                                   const jitk::LoopB &block,
                                   const vector<uint64_t> &thread_stack,
                                   stringstream &out) {
-    // Let's write the OpenMP loop header
-    int64_t for_loop_size = block.size;
-    // No need to parallel one-sized loops
-    if (for_loop_size > 1) {
-        writeHeader(symbols, scope, block, out);
-    }
-    // Write the for-loop header
-    string itername;
+    // Find the iteration space of the for-loop
+    string itername, begin, end;
     {
         stringstream t;
         t << "i" << block.rank;
         itername = t.str();
     }
-    out << "for(uint64_t " << itername << " = 0; ";
-    out << itername << " < " << block.size << "; ++" << itername << ") {\n";
+    if (_writing_chunked and block.rank == 0) {
+        // The outermost loop of a chunked kernel iterates over the chunk given by the caller
+        begin = "chunk_begin";
+        end = "chunk_end";
+    } else {
+        stringstream t;
+        if (symbols.existLoopSizeID(block)) {
+            t << "vl" << symbols.loopSizeID(block);
+        } else {
+            t << block.size;
+        }
+        begin = "0";
+        end = t.str();
+    }
+
+    if (block.isInnermost()) {
+        findPrefetches(scope, block);
+    }
+
+    // Let's write the OpenMP loop header
+    // NB: the header must be written before checking the explicit SIMD path since it updates `scope`
+    stringstream header;
+    if (scanCompatible(scope, block)) {
+        // The loop is the first pass of a parallel scan, which iterates over the chunk of the thread
+        _scans = order_sweep_set(block._sweeps, symbols);
+        ++_num_scans;
+        header << "{ // Parallel scan: each thread scans a chunk, then the preceding chunks are added to the chunk\n";
+        for (size_t i = 0; i < _scans.size(); ++i) {
+            util::spaces(header, 4);
+            header << writeType(_scans[i]->operand_type(0)) << " scan_carry" << i << "[omp_get_max_threads()];\n";
+        }
+        util::spaces(header, 4);
+        header << "#pragma omp parallel\n";
+        util::spaces(header, 4);
+        header << "{\n";
+        util::spaces(header, 8);
+        header << "const uint64_t scan_nthds = omp_get_num_threads(), scan_tid = omp_get_thread_num();\n";
+        util::spaces(header, 8);
+        header << "const uint64_t scan_begin = " << end << " * scan_tid / scan_nthds;\n";
+        util::spaces(header, 8);
+        header << "const uint64_t scan_end = " << end << " * (scan_tid + 1) / scan_nthds;\n";
+        util::spaces(header, 4);
+        begin = "scan_begin";
+        end = "scan_end";
+    } else if (block.size > 1) { // No need to parallel one-sized loops
+        writeHeader(symbols, scope, block, header);
+    }
+    // The explicitly vectorized loop goes before the for-loop, which then executes the remaining iterations
+    bool vectorized = false;
+    if (compiler_explicit_simd and block.isInnermost()) {
+        ++_num_innermost_loops;
+        string reason;
+        const int64_t lanes = simdLanes(symbols, scope, block, reason);
+        if (lanes > 0) {
+            begin = writeSimdLoop(symbols, scope, block, lanes, begin, end, out);
+            ++_num_simd_loops;
+            vectorized = true;
+        } else {
+            out << "// No explicit SIMD: " << reason << "\n";
+            util::spaces(out, 4 + block.rank * 4);
+        }
+    }
+    // Otherwise, the reductions of the innermost loop might accumulate into multiple scalars the same way
+    if (not vectorized and block.isInnermost() and scalarAccumulators(symbols, scope, block)) {
+        begin = writeSimdLoop(symbols, scope, block, 1, begin, end, out);
+    }
+    // Write the for-loop header
+    out << header.str();
+    out << "for(uint64_t " << itername << " = " << begin << "; ";
+    out << itername << " < " << end << "; ++" << itername << ") {\n";
+    if (block.isInnermost()) {
+        _prefetch_rank = block.rank;
+        _prefetch_end = end;
+    }
+}
+
+namespace {
+// Write the stride of `view` along `axis`
+string view_stride(const jitk::Scope &scope, const bh_view &view, int axis) {
+    stringstream ss;
+    if (scope.symbols.strides_as_var and scope.symbols.existOffsetStridesID(view)) {
+        ss << "vs" << scope.symbols.offsetStridesID(view) << "_" << axis;
+    } else {
+        ss << view.stride[axis];
+    }
+    return ss.str();
+}
+
+// Write the element of `view` that is `offset` iterations of the innermost loop, `axis`, ahead of the current
+// iteration. NB: `view` must be an array in memory.
+string element_ahead(const jitk::Scope &scope, const bh_view &view, int axis, int64_t offset) {
+    stringstream ss;
+    ss << "a" << scope.symbols.baseID(view.base) << "[(";
+    write_array_index(scope, view, ss, true);
+    ss << ")";
+    if (offset != 0) {
+        ss << " + " << offset << " * " << view_stride(scope, view, axis);
+    }
+    ss << "]";
+    return ss.str();
+}
+}
+
+void EngineOpenMP::findPrefetches(const jitk::Scope &scope, const jitk::LoopB &block) {
+    _prefetches.clear();
+    _prefetch_rank = -1;
+    if (compiler_prefetch_distance == 0) {
+        return;
+    }
+    // The arrays written by the loop, which cannot be read ahead of the loop
+    set<bh_base *> outputs;
+    for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(block)) {
+        if (not bh_opcode_is_system(instr->opcode) and not instr->operand.empty()) {
+            outputs.insert(instr->operand[0].base);
+        }
+    }
+    const set<bh_base *> local_tmps = block.getLocalTemps();
+    for (const jitk::InstrPtr &instr: jitk::iterator::allLocalInstr(block)) {
+        if (not(instr->opcode == BH_GATHER or instr->opcode == BH_SCATTER or instr->opcode == BH_COND_SCATTER)) {
+            continue;
+        }
+        // The index must be an array in memory that the loop iterates along its last axis
+        const bh_view &index = instr->operand[2];
+        if (index.ndim != block.rank + 1 or scope.isTmp(index.base) or util::exist(local_tmps, index.base) or
+            util::exist(outputs, index.base)) {
+            continue;
+        }
+        Prefetch prefetch;
+        prefetch.instr = instr;
+        prefetch.sorted_check = compiler_sorted_index_check;
+        _prefetches[instr.get()] = prefetch;
+    }
+}
+
+bool EngineOpenMP::scanCompatible(const jitk::Scope &scope, const jitk::LoopB &block) const {
+    if (not(compiler_openmp and compiler_openmp_scan and block.rank == 0 and block.size > 1 and
+            not _writing_chunked and block.isInnermost() and not block._sweeps.empty())) {
+        return false;
+    }
+    set<bh_base *> outputs;
+    for (const jitk::InstrPtr &instr: block._sweeps) {
+        if (not(instr->opcode == BH_ADD_ACCUMULATE or instr->opcode == BH_MULTIPLY_ACCUMULATE) or
+            not scope.isArray(instr->operand[0])) {
+            return false;
+        }
+        outputs.insert(instr->operand[0].base);
+    }
+    // The first pass computes the scan of the chunk only, thus no other instruction may access the scan
+    for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(block)) {
+        if (bh_opcode_is_system(instr->opcode) or util::exist(block._sweeps, instr)) {
+            continue;
+        }
+        for (const bh_view &view: instr->getViews()) {
+            if (util::exist(outputs, view.base)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int64_t EngineOpenMP::simdLanes(const jitk::SymbolTable &symbols,
+                                const jitk::Scope &scope,
+                                const jitk::LoopB &block,
+                                std::string &reason) const {
+    if (block.rank == 0 and not _partials.empty()) {
+        reason = "thread-private partial reductions";
+        return 0;
+    }
+    if (block.rank == 0 and not _scans.empty()) {
+        reason = "parallel scan";
+        return 0;
+    }
+    const set<bh_base *> local_tmps = block.getLocalTemps();
+    // The reduction outputs, which are accumulated in vector registers
+    set<bh_base *> reduction_bases;
+    // The view of each base, which must be the same for all accesses of the base
+    map<bh_base *, bh_view> base_views;
+    int64_t max_itemsize = 1;
+    for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(block)) {
+        if (bh_opcode_is_system(instr->opcode)) {
+            continue;
+        }
+        if (scope.isOpenmpAtomic(instr) or scope.isOpenmpCritical(instr)) {
+            reason = "OpenMP atomic or critical operation";
+            return 0;
+        }
+        if (not jitk::vector_operation_compatible(*instr)) {
+            stringstream ss;
+            ss << "unsupported operation " << bh_opcode_text(instr->opcode) << " of "
+               << bh_type_text(instr->operand_type(0));
+            reason = ss.str();
+            return 0;
+        }
+        if (instr->opcode == BH_IDENTITY and not compiler_vector_convert and not instr->operand[1].isConstant() and
+            instr->operand_type(0) != instr->operand_type(1)) {
+            reason = "type conversion without compiler support of __builtin_convertvector";
+            return 0;
+        }
+        for (size_t o = 0; o < instr->operand.size(); ++o) {
+            const bh_view &view = instr->operand[o];
+            if (view.isConstant()) {
+                continue;
+            }
+            max_itemsize = std::max<int64_t>(max_itemsize, bh_type_size(view.base->dtype()));
+            if (o == 0 and bh_opcode_is_reduction(instr->opcode)) {
+                if (not(jitk::sweeping_innermost_axis(instr) and scope.isScalarReplaced(view))) {
+                    reason = "reduction of an outer axis";
+                    return 0;
+                }
+                reduction_bases.insert(view.base);
+                continue;
+            }
+            if (view.ndim != block.rank + 1) {
+                reason = "operand of a different rank than the loop";
+                return 0;
+            }
+            if (util::exist(local_tmps, view.base)) {
+                if (symbols.isAlwaysArray(view.base)) {
+                    reason = "temporary array";
+                    return 0;
+                }
+            } else if (not scope.isArray(view)) {
+                reason = "scalar-replaced operand";
+                return 0;
+            } else if (not(symbols.strides_as_var and symbols.existOffsetStridesID(view)) and
+                       view.stride[block.rank] != 1) {
+                reason = "non-contiguous operand";
+                return 0;
+            }
+            auto it = base_views.find(view.base);
+            if (it == base_views.end()) {
+                base_views.insert(make_pair(view.base, view));
+            } else if (not(it->second == view)) {
+                reason = "different views of the same array";
+                return 0;
+            }
+        }
+    }
+    for (bh_base *base: reduction_bases) {
+        if (util::exist(base_views, base)) {
+            reason = "reduction output accessed as an array";
+            return 0;
+        }
+    }
+    const int64_t lanes = compiler_simd_width / max_itemsize;
+    if (lanes < 2) {
+        reason = "vectors of fewer than two elements";
+        return 0;
+    }
+    if (not symbols.existLoopSizeID(block) and block.size < lanes) {
+        reason = "fewer iterations than vector lanes";
+        return 0;
+    }
+    return lanes;
+}
+
+bool EngineOpenMP::scalarAccumulators(const jitk::SymbolTable &symbols,
+                                      const jitk::Scope &scope,
+                                      const jitk::LoopB &block) const {
+    if (block._sweeps.empty() or (block.rank == 0 and not(_partials.empty() and _scans.empty())) or
+        (not symbols.existLoopSizeID(block) and block.size < compiler_reduction_accumulators)) {
+        return false;
+    }
+    bool pairwise = false;
+    for (const jitk::InstrPtr &instr: block._sweeps) {
+        if (not bh_opcode_is_reduction(instr->opcode)) {
+            return false;
+        }
+        pairwise |= compiler_pairwise_sum and instr->opcode == BH_ADD_REDUCE and
+                    bh_type_is_float(instr->operand_type(0));
+    }
+    // An OpenMP SIMD loop already accumulates into vectors, which leaves only the pairwise sum
+    if (not pairwise and (compiler_reduction_accumulators < 2 or
+                          (compiler_openmp_simd and simd_compatible(block, scope)))) {
+        return false;
+    }
+    const set<bh_base *> local_tmps = block.getLocalTemps();
+    set<bh_base *> reduction_bases;
+    map<bh_base *, bh_view> base_views;
+    for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(block)) {
+        if (bh_opcode_is_system(instr->opcode)) {
+            continue;
+        }
+        // The steps write the operations like `writeInstr()` does for element-wise operations and reductions
+        if (scope.isOpenmpAtomic(instr) or scope.isOpenmpCritical(instr) or bh_opcode_is_accumulate(instr->opcode) or
+            instr->opcode == BH_RANGE or instr->opcode == BH_RANDOM or instr->opcode == BH_GATHER or
+            instr->opcode == BH_SCATTER or instr->opcode == BH_COND_SCATTER) {
+            return false;
+        }
+        for (size_t o = 0; o < instr->operand.size(); ++o) {
+            const bh_view &view = instr->operand[o];
+            if (view.isConstant()) {
+                continue;
+            }
+            if (o == 0 and bh_opcode_is_reduction(instr->opcode)) {
+                if (not(jitk::sweeping_innermost_axis(instr) and scope.isScalarReplaced(view))) {
+                    return false;
+                }
+                reduction_bases.insert(view.base);
+                continue;
+            }
+            if (util::exist(local_tmps, view.base)) {
+                if (symbols.isAlwaysArray(view.base)) {
+                    return false;
+                }
+            } else if (not scope.isArray(view)) {
+                return false;
+            }
+            // NB: the arrays are loaded at the first access of each step and stored at the end of the step
+            auto it = base_views.find(view.base);
+            if (it == base_views.end()) {
+                base_views.insert(make_pair(view.base, view));
+            } else if (not(it->second == view)) {
+                return false;
+            }
+        }
+    }
+    for (bh_base *base: reduction_bases) {
+        if (util::exist(base_views, base)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string EngineOpenMP::simdType(bh_type dtype, int64_t lanes) {
+    const string type = writeType(dtype);
+    stringstream name;
+    name << "bhv" << lanes << "_" << type;
+    if (_simd_typedefs.find(name.str()) == _simd_typedefs.end()) {
+        // NB: the guard makes it possible to combine multiple kernels into one translation unit
+        stringstream ss;
+        ss << "#ifndef BH_" << name.str() << "\n#define BH_" << name.str() << "\n";
+        ss << "typedef " << type << " " << name.str() << " __attribute__((vector_size("
+           << lanes * bh_type_size(dtype) << ")));\n";
+        ss << "#endif\n";
+        _simd_typedefs[name.str()] = ss.str();
+    }
+    return name.str();
+}
+
+namespace {
+// Find the loops from `loop` to the loop that contains `instr`. Returns false when `loop` doesn't contain `instr`.
+bool find_enclosing_loops(const jitk::LoopB &loop, const jitk::InstrPtr &instr, vector<const jitk::LoopB *> &out) {
+    out.push_back(&loop);
+    for (const jitk::Block &b: loop._block_list) {
+        if (b.isInstr()) {
+            if (b.getInstr() == instr) {
+                return true;
+            }
+        } else if (find_enclosing_loops(b.getLoop(), instr, out)) {
+            return true;
+        }
+    }
+    out.pop_back();
+    return false;
+}
+
+// Return the signed integer type of the same size as `dtype`, which is the element type of comparison results
+bh_type simd_mask_type(bh_type dtype) {
+    switch (bh_type_size(dtype)) {
+        case 1:
+            return bh_type::INT8;
+        case 2:
+            return bh_type::INT16;
+        case 4:
+            return bh_type::INT32;
+        default:
+            return bh_type::INT64;
+    }
+}
+}
+
+std::string EngineOpenMP::writeSimdLoop(const jitk::SymbolTable &symbols,
+                                        jitk::Scope &scope,
+                                        const jitk::LoopB &block,
+                                        int64_t lanes,
+                                        const std::string &begin,
+                                        const std::string &end,
+                                        std::stringstream &out) {
+    const int indent = 4 + block.rank * 4;
+    stringstream itername;
+    itername << "i" << block.rank;
+    // The temporary arrays of the loop are vector variables, which `scope` doesn't know yet
+    const set<bh_base *> local_tmps = block.getLocalTemps();
+    auto in_memory = [&](const bh_view &view) -> bool {
+        return scope.isArray(view) and not util::exist(local_tmps, view.base);
+    };
+
+    // With one lane, the steps are scalar operations
+    const bool scalar = lanes == 1;
+    auto vector_type = [&](bh_type dtype) -> string {
+        return scalar ? writeType(dtype) : simdType(dtype, lanes);
+    };
+
+    // Strides that are kernel arguments must be one at runtime, otherwise all iterations goes to the remainder
+    stringstream guard;
+    if (not scalar) {
+        set<size_t> offset_strides_ids;
+        for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(block)) {
+            for (size_t o = 0; o < instr->operand.size(); ++o) {
+                const bh_view &view = instr->operand[o];
+                if (not(view.isConstant() or (o == 0 and bh_opcode_is_reduction(instr->opcode))) and
+                    in_memory(view) and symbols.strides_as_var and symbols.existOffsetStridesID(view)) {
+                    offset_strides_ids.insert(symbols.offsetStridesID(view));
+                }
+            }
+        }
+        for (size_t id: offset_strides_ids) {
+            if (not guard.str().empty()) {
+                guard << " && ";
+            }
+            guard << "vs" << id << "_" << block.rank << " == 1";
+        }
+    }
+    // Like the for-loop, the outermost loop of a kernel executes in parallel
+    const vector<jitk::InstrPtr> ordered_block_sweeps = order_sweep_set(block._sweeps, symbols);
+    const bool parallel = compiler_openmp and block.rank == 0 and block.size > 1 and not _writing_chunked and
+                          openmp_compatible(block);
+    // Each reduction accumulates into `num_accs` vectors, which are independent thus the additions of consecutive
+    // iterations don't have to wait for each other. Each iteration of the vectorized loop does `num_accs` steps.
+    const int64_t num_accs = ordered_block_sweeps.empty() ? 1 : compiler_reduction_accumulators;
+    const int64_t step = lanes * num_accs;
+    // The floating-point add-reductions, which are summed in blocks of `pairwise_block` iterations
+    // of the vectorized loop. The block sums are added pairwise using a stack of partial sums.
+    set<jitk::InstrPtr> pairwise;
+    if (compiler_pairwise_sum) {
+        for (const jitk::InstrPtr &instr: ordered_block_sweeps) {
+            if (instr->opcode == BH_ADD_REDUCE and bh_type_is_float(instr->operand_type(0))) {
+                pairwise.insert(instr);
+            }
+        }
+    }
+    const int64_t pairwise_block = 16;
+    // The iterator of the vectorized loop when the steps are written as separate blocks
+    const string step_iter = num_accs > 1 or not pairwise.empty() ? itername.str() + "_simd" : itername.str();
+
+    stringstream simd_end;
+    simd_end << "(" << begin << " + ";
+    if (not guard.str().empty()) {
+        simd_end << "(" << guard.str() << " ? ";
+    }
+    simd_end << "(" << end << " - " << begin << ") / " << step << " * " << step;
+    if (not guard.str().empty()) {
+        simd_end << " : 0)";
+    }
+    simd_end << ")";
+
+    if (scalar) {
+        out << "{ // Loop of " << num_accs << " scalar accumulators, the loop below executes the remaining iterations\n";
+    } else {
+        out << "{ // Explicit SIMD loop of " << lanes << " lanes, the loop below executes the remaining iterations\n";
+    }
+    util::spaces(out, indent + 4);
+    out << "const uint64_t " << itername.str() << "_simd_end = " << simd_end.str() << ";\n";
+    if (parallel) {
+        util::spaces(out, indent + 4);
+        out << "#pragma omp parallel";
+        for (const jitk::InstrPtr &instr: ordered_block_sweeps) {
+            out << " reduction(" << openmp_reduce_symbol(instr->opcode) << ":";
+            scope.getName(instr->operand[0], out);
+            out << ")";
+        }
+        out << "\n";
+    }
+    util::spaces(out, indent + 4);
+    out << "{\n";
+
+    // The vector accumulators of the reductions start at the identity
+    map<jitk::InstrPtr, string> accumulators;
+    auto accumulator = [&](const jitk::InstrPtr &instr, int64_t i) -> string {
+        stringstream ss;
+        ss << accumulators.at(instr) << "_" << i;
+        return ss.str();
+    };
+    auto write_reset = [&](const jitk::InstrPtr &instr, bool declare, int ind) {
+        const bh_type dtype = instr->operand_type(0);
+        for (int64_t i = 0; i < num_accs; ++i) {
+            util::spaces(out, ind);
+            if (declare) {
+                out << vector_type(dtype) << " ";
+            }
+            out << accumulator(instr, i) << " = ";
+            if (not scalar) {
+                out << "(" << simdType(dtype, lanes) << "){0} + ";
+            }
+            out << "(" << writeType(dtype) << ")(";
+            jitk::sweep_identity(instr->opcode, dtype).pprint(out, false);
+            out << ");\n";
+        }
+    };
+    for (const jitk::InstrPtr &instr: ordered_block_sweeps) {
+        stringstream name;
+        name << "r" << accumulators.size();
+        accumulators[instr] = name.str();
+        write_reset(instr, true, indent + 8);
+        if (util::exist(pairwise, instr)) {
+            // NB: 64 partial sums is enough for 2^64 blocks
+            util::spaces(out, indent + 8);
+            out << writeType(instr->operand_type(0)) << " " << name.str() << "_stack[64];\n";
+            util::spaces(out, indent + 8);
+            out << "uint64_t " << name.str() << "_nblocks = 0, " << name.str() << "_top = 0;\n";
+        }
+    }
+    // Only the selects of maximum and minimum need the comparison mask type
+    auto mask_type = [&](const bh_instruction &instr) -> string {
+        if (instr.opcode == BH_MAXIMUM or instr.opcode == BH_MINIMUM or instr.opcode == BH_MAXIMUM_REDUCE or
+            instr.opcode == BH_MINIMUM_REDUCE) {
+            return simdType(simd_mask_type(instr.operand_type(0)), lanes);
+        }
+        return "";
+    };
+    // Combine the accumulators of `instr` pairwise into the first accumulator
+    auto write_combine = [&](const jitk::InstrPtr &instr, int ind) {
+        for (int64_t dist = 1; dist < num_accs; dist *= 2) {
+            for (int64_t i = 0; i + dist < num_accs; i += 2 * dist) {
+                util::spaces(out, ind);
+                if (scalar) {
+                    jitk::write_operation(*instr, {accumulator(instr, i), accumulator(instr, i + dist)}, out, false);
+                } else {
+                    jitk::write_vector_operation(*instr, {accumulator(instr, i), accumulator(instr, i + dist)},
+                                                 simdType(instr->operand_type(0), lanes), mask_type(*instr), out);
+                }
+            }
+        }
+    };
+    // Write one step of the vectorized loop, which uses the accumulators of index `acc`
+    auto write_step = [&](int64_t acc, int ind) {
+        // The vector variable of each view and the order in which the arrays are written
+        map<bh_view, string> variables;
+        vector<bh_view> written_arrays;
+        for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(block)) {
+            if (bh_opcode_is_system(instr->opcode)) {
+                continue;
+            }
+            const bh_type dtype = instr->operand_type(0);
+            // NB: we visit the output operand last such that an output that is also an input is loaded
+            vector<string> ops(instr->operand.size());
+            for (size_t i = 1; i <= instr->operand.size(); ++i) {
+                const size_t o = i % instr->operand.size();
+                const bh_view &view = instr->operand[o];
+                stringstream op;
+                if (view.isConstant()) {
+                    if (not scalar) {
+                        op << "((" << simdType(dtype, lanes) << "){0} + (" << writeType(dtype) << ")(";
+                    }
+                    const int64_t constID = symbols.constID(*instr);
+                    if (constID >= 0) {
+                        op << "c" << constID;
+                    } else {
+                        instr->constant.pprint(op, false);
+                    }
+                    if (not scalar) {
+                        op << "))";
+                    }
+                } else if (o == 0 and bh_opcode_is_reduction(instr->opcode)) {
+                    op << accumulator(instr, acc);
+                } else {
+                    auto it = variables.find(view);
+                    if (it == variables.end()) {
+                        stringstream name;
+                        name << "v" << variables.size();
+                        it = variables.insert(make_pair(view, name.str())).first;
+                        util::spaces(out, ind);
+                        out << vector_type(view.base->dtype()) << " " << name.str() << ";\n";
+                        if (o > 0 and in_memory(view)) { // Load the input array
+                            util::spaces(out, ind);
+                            if (scalar) {
+                                out << name.str() << " = " << scope.getName(view);
+                                write_array_subscription(scope, view, out, true);
+                                out << ";\n";
+                            } else {
+                                out << "__builtin_memcpy(&" << name.str() << ", &" << scope.getName(view);
+                                write_array_subscription(scope, view, out, true);
+                                out << ", sizeof(" << name.str() << "));\n";
+                            }
+                        }
+                    }
+                    if (o == 0 and in_memory(view) and
+                        std::find(written_arrays.begin(), written_arrays.end(), view) == written_arrays.end()) {
+                        written_arrays.push_back(view);
+                    }
+                    op << it->second;
+                }
+                ops[o] = op.str();
+            }
+            util::spaces(out, ind);
+            if (scalar) {
+                jitk::write_operation(*instr, ops, out, false);
+            } else {
+                jitk::write_vector_operation(*instr, ops, simdType(dtype, lanes), mask_type(*instr), out);
+            }
+        }
+        // Store the output arrays
+        for (const bh_view &view: written_arrays) {
+            util::spaces(out, ind);
+            if (scalar) {
+                out << scope.getName(view);
+                write_array_subscription(scope, view, out, true);
+                out << " = " << variables.at(view) << ";\n";
+            } else {
+                out << "__builtin_memcpy(&" << scope.getName(view);
+                write_array_subscription(scope, view, out, true);
+                out << ", &" << variables.at(view) << ", sizeof(" << variables.at(view) << "));\n";
+            }
+        }
+    };
+    // Write the vectorized loop from `loop_begin` to `loop_end`
+    auto write_loop = [&](const string &loop_begin, const string &loop_end, int ind) {
+        util::spaces(out, ind);
+        out << "for(uint64_t " << step_iter << " = " << loop_begin << "; " << step_iter << " < " << loop_end
+            << "; " << step_iter << " += " << step << ") {\n";
+        if (step_iter == itername.str()) {
+            write_step(0, ind + 4);
+        } else {
+            // Each step is a block that defines the iterator of the loop body
+            for (int64_t i = 0; i < num_accs; ++i) {
+                util::spaces(out, ind + 4);
+                out << "{\n";
+                util::spaces(out, ind + 8);
+                out << "const uint64_t " << itername.str() << " = " << step_iter;
+                if (i > 0) {
+                    out << " + " << i * lanes;
+                }
+                out << ";\n";
+                write_step(i, ind + 8);
+                util::spaces(out, ind + 4);
+                out << "}\n";
+            }
+        }
+        util::spaces(out, ind);
+        out << "}\n";
+    };
+
+    if (parallel) {
+        util::spaces(out, indent + 8);
+        out << "#pragma omp for\n";
+    }
+    if (pairwise.empty()) {
+        write_loop(begin, itername.str() + "_simd_end", indent + 8);
+    } else {
+        const string block_iter = itername.str() + "_block";
+        util::spaces(out, indent + 8);
+        out << "for(uint64_t " << block_iter << " = " << begin << "; " << block_iter << " < " << itername.str()
+            << "_simd_end; " << block_iter << " += " << step * pairwise_block << ") {\n";
+        util::spaces(out, indent + 12);
+        out << "const uint64_t " << block_iter << "_end = " << block_iter << " + " << step * pairwise_block
+            << " < " << itername.str() << "_simd_end ? " << block_iter << " + " << step * pairwise_block << " : "
+            << itername.str() << "_simd_end;\n";
+        write_loop(block_iter, block_iter + "_end", indent + 12);
+        // Push the sum of the block onto the stack, which adds the partial sums of equal size
+        for (const jitk::InstrPtr &instr: ordered_block_sweeps) {
+            if (not util::exist(pairwise, instr)) {
+                continue;
+            }
+            const string name = accumulators.at(instr);
+            write_combine(instr, indent + 12);
+            util::spaces(out, indent + 12);
+            if (scalar) {
+                out << writeType(instr->operand_type(0)) << " " << name << "_sum = " << accumulator(instr, 0)
+                    << ";\n";
+            } else {
+                out << writeType(instr->operand_type(0)) << " " << name << "_sum = 0;\n";
+                util::spaces(out, indent + 12);
+                out << "for(int lane = 0; lane < " << lanes << "; ++lane) {\n";
+                util::spaces(out, indent + 16);
+                out << name << "_sum += " << accumulator(instr, 0) << "[lane];\n";
+                util::spaces(out, indent + 12);
+                out << "}\n";
+            }
+            write_reset(instr, false, indent + 12);
+            util::spaces(out, indent + 12);
+            out << "for(uint64_t n = " << name << "_nblocks++; n & 1; n >>= 1) {\n";
+            util::spaces(out, indent + 16);
+            out << name << "_sum += " << name << "_stack[--" << name << "_top];\n";
+            util::spaces(out, indent + 12);
+            out << "}\n";
+            util::spaces(out, indent + 12);
+            out << name << "_stack[" << name << "_top++] = " << name << "_sum;\n";
+        }
+        util::spaces(out, indent + 8);
+        out << "}\n";
+    }
+
+    // Let's combine the accumulators with the scalar-replaced reduction outputs
+    for (const jitk::InstrPtr &instr: ordered_block_sweeps) {
+        const string output = scope.getName(instr->operand[0]);
+        if (util::exist(pairwise, instr)) {
+            const string name = accumulators.at(instr);
+            util::spaces(out, indent + 8);
+            out << "while(" << name << "_top > 0) {\n";
+            util::spaces(out, indent + 12);
+            jitk::write_operation(*instr, {output, name + "_stack[--" + name + "_top]"}, out, false);
+            util::spaces(out, indent + 8);
+            out << "}\n";
+        } else if (scalar) {
+            write_combine(instr, indent + 8);
+            util::spaces(out, indent + 8);
+            jitk::write_operation(*instr, {output, accumulator(instr, 0)}, out, false);
+        } else {
+            write_combine(instr, indent + 8);
+            util::spaces(out, indent + 8);
+            out << "for(int lane = 0; lane < " << lanes << "; ++lane) {\n";
+            util::spaces(out, indent + 12);
+            jitk::write_operation(*instr, {output, accumulator(instr, 0) + "[lane]"}, out, false);
+            util::spaces(out, indent + 8);
+            out << "}\n";
+        }
+    }
+    util::spaces(out, indent + 4);
+    out << "}\n";
+    util::spaces(out, indent);
+    out << "}\n";
+    util::spaces(out, indent);
+    return simd_end.str();
 }
 
 // Writing the OpenMP header, which include "parallel for" and "simd"
@@ -286,22 +1432,57 @@ void EngineOpenMP::writeHeader(const jitk::SymbolTable &symbols,
     // This makes the source of the kernels more identical, which improve the code and compile caches.
     const std::vector<jitk::InstrPtr> ordered_block_sweeps = order_sweep_set(block._sweeps, symbols);
 
+    // Each thread allocates a partial as large as the output, thus only outputs of constant sizes of at most
+    // `compiler_openmp_partials_max_elements` elements get partials
+    auto partial_fits = [&](const bh_view &view, const vector<const jitk::LoopB *> &loops) {
+        if (view.is_scalar()) {
+            return true;
+        }
+        int64_t nelem = 1;
+        for (size_t i = 1; i < loops.size(); ++i) {
+            if (symbols.existLoopSizeID(*loops[i])) {
+                return false;
+            }
+            nelem *= loops[i]->size;
+        }
+        return nelem <= compiler_openmp_partials_max_elements;
+    };
+
     stringstream ss;
-    // "OpenMP for" goes to the outermost loop
-    if (block.rank == 0 and openmp_compatible(block)) {
-        ss << " parallel for";
-        // Since we are doing parallel for, we should either do OpenMP reductions or protect the sweep instructions
+    // "OpenMP for" goes to the outermost loop unless the loop is split by the execution pool
+    if (block.rank == 0 and not _writing_chunked and openmp_compatible(block)) {
+        // Since we are doing parallel for, we should either do OpenMP reductions or use thread-private partials.
+        // Only when the output doesn't match the loops, we protect the sweep instructions.
         for (const jitk::InstrPtr &instr: ordered_block_sweeps) {
             assert(instr->operand.size() == 3);
             const bh_view &view = instr->operand[0];
+            vector<const jitk::LoopB *> loops;
             if (openmp_reduce_compatible(instr->opcode) and (scope.isScalarReplaced(view) or scope.isTmp(view.base))) {
                 openmp_reductions.push_back(instr);
+            } else if (compiler_openmp_partials and find_enclosing_loops(block, instr, loops) and
+                       (view.is_scalar() or view.ndim + 1 == static_cast<int64_t>(loops.size())) and
+                       partial_fits(view, loops)) {
+                Partial partial;
+                partial.instr = instr;
+                stringstream name;
+                name << "p" << _partials.size();
+                partial.name = name.str();
+                if (not view.is_scalar()) {
+                    for (size_t i = 1; i < loops.size(); ++i) {
+                        stringstream size;
+                        size << loops[i]->size;
+                        partial.sizes.push_back(size.str());
+                    }
+                }
+                _partials.push_back(std::move(partial));
             } else if (openmp_atomic_compatible(instr->opcode)) {
                 scope.insertOpenmpAtomic(instr);
             } else {
                 scope.insertOpenmpCritical(instr);
             }
         }
+        // With partials, the parallel region encloses the loop and the combining of the partials
+        ss << (_partials.empty() ? " parallel for" : " for");
     }
 
     // "OpenMP SIMD" goes to the innermost loop (which might also be the outermost loop)
@@ -321,6 +1502,36 @@ void EngineOpenMP::writeHeader(const jitk::SymbolTable &symbols,
         scope.getName(instr->operand[0], ss);
         ss << ")";
     }
+    // Let's declare the partials, which start at the identity of the reduction
+    if (block.rank == 0 and not _partials.empty()) {
+        out << "#pragma omp parallel\n";
+        util::spaces(out, 4);
+        out << "{ // Thread-private partial reductions, which are combined after the loop\n";
+        for (const Partial &partial: _partials) {
+            const string type = writeType(partial.instr->operand_type(0));
+            stringstream identity;
+            jitk::sweep_identity(partial.instr->opcode, partial.instr->operand_type(0)).pprint(identity, false);
+            util::spaces(out, 8);
+            if (partial.sizes.empty()) {
+                out << type << " " << partial.name << " = " << identity.str() << ";\n";
+            } else {
+                stringstream nelem_ss;
+                for (const string &size: partial.sizes) {
+                    nelem_ss << (nelem_ss.str().empty() ? "" : " * ") << size;
+                }
+                const string nelem = nelem_ss.str();
+                out << type << " *" << partial.name << " = (" << type << " *)malloc(" << nelem << " * sizeof("
+                    << type << "));\n";
+                util::spaces(out, 8);
+                out << "for(uint64_t k = 0; k < " << nelem << "; ++k) {\n";
+                util::spaces(out, 12);
+                out << partial.name << "[k] = " << identity.str() << ";\n";
+                util::spaces(out, 8);
+                out << "}\n";
+            }
+        }
+        util::spaces(out, 4);
+    }
     const string ss_str = ss.str();
     if (not ss_str.empty()) {
         out << "#pragma omp" << ss_str << "\n";
@@ -328,6 +1539,200 @@ void EngineOpenMP::writeHeader(const jitk::SymbolTable &symbols,
     }
 }
 
+namespace {
+// Return the element of the partial array that corresponds to the current iteration of the loops of the output
+// in row-major order, e.g. `(i1*s2 + i2)*s3 + i3` where `s2` and `s3` are the sizes of the second and third loop
+string partial_index(const vector<string> &sizes) {
+    string ret = "i1";
+    for (size_t i = 1; i < sizes.size(); ++i) {
+        stringstream ss;
+        ss << (i > 1 ? "(" + ret + ")" : ret) << "*" << sizes[i] << " + i" << i + 1;
+        ret = ss.str();
+    }
+    return ret;
+}
+}
+
+// Writes the combining of the partials of the outermost loop with the outputs of the reductions
+void EngineOpenMP::loopTailWriter(const jitk::SymbolTable &symbols,
+                                  jitk::Scope &scope,
+                                  const jitk::LoopB &block,
+                                  std::stringstream &out) {
+    if (block.isInnermost()) {
+        _prefetches.clear();
+        _prefetch_rank = -1;
+    }
+    if (block.rank == 0 and not _scans.empty()) {
+        writeScanTail(scope, out);
+        return;
+    }
+    if (block.rank != 0 or _partials.empty()) {
+        return;
+    }
+    // The threads combine their partials one at a time
+    util::spaces(out, 4);
+    out << "#pragma omp critical\n";
+    util::spaces(out, 4);
+    out << "{\n";
+    for (const Partial &partial: _partials) {
+        const bh_view &view = partial.instr->operand[0];
+        stringstream output;
+        scope.getName(view, output);
+        if (scope.isArray(view)) {
+            write_array_subscription(scope, view, output, true, partial.instr->sweep_axis());
+        }
+        // The loops over the output use the iterator names of the loops that enclose the reduction
+        for (size_t i = 0; i < partial.sizes.size(); ++i) {
+            util::spaces(out, 8 + i * 4);
+            out << "for(uint64_t i" << i + 1 << " = 0; i" << i + 1 << " < " << partial.sizes[i] << "; ++i"
+                << i + 1 << ") {\n";
+        }
+        util::spaces(out, 8 + partial.sizes.size() * 4);
+        if (partial.sizes.empty()) {
+            jitk::write_operation(*partial.instr, {output.str(), partial.name}, out, false);
+        } else {
+            jitk::write_operation(*partial.instr,
+                                  {output.str(), partial.name + "[" + partial_index(partial.sizes) + "]"}, out,
+                                  false);
+        }
+        for (size_t i = partial.sizes.size(); i > 0; --i) {
+            util::spaces(out, 4 + i * 4);
+            out << "}\n";
+        }
+    }
+    util::spaces(out, 4);
+    out << "}\n";
+    for (const Partial &partial: _partials) {
+        if (not partial.sizes.empty()) {
+            util::spaces(out, 4);
+            out << "free(" << partial.name << ");\n";
+        }
+    }
+    util::spaces(out, 4);
+    out << "}\n";
+    _partials.clear();
+}
+
+void EngineOpenMP::writeScanTail(jitk::Scope &scope, std::stringstream &out) {
+    // The carry of a chunk is its last element
+    for (size_t i = 0; i < _scans.size(); ++i) {
+        const bh_view &view = _scans[i]->operand[0];
+        util::spaces(out, 8);
+        out << "{\n";
+        util::spaces(out, 12);
+        out << "const uint64_t i0 = scan_end - 1;\n";
+        util::spaces(out, 12);
+        out << "scan_carry" << i << "[scan_tid] = scan_begin < scan_end ? " << scope.getName(view);
+        write_array_subscription(scope, view, out, true);
+        out << " : ";
+        jitk::sweep_identity(_scans[i]->opcode, _scans[i]->operand_type(0)).pprint(out, false);
+        out << ";\n";
+        util::spaces(out, 8);
+        out << "}\n";
+    }
+    util::spaces(out, 8);
+    out << "#pragma omp barrier\n";
+    // Let's combine the carries of the preceding chunks
+    util::spaces(out, 8);
+    out << "if (scan_tid > 0) {\n";
+    for (size_t i = 0; i < _scans.size(); ++i) {
+        stringstream offset, carry;
+        offset << "scan_offset" << i;
+        carry << "scan_carry" << i << "[t]";
+        util::spaces(out, 12);
+        out << writeType(_scans[i]->operand_type(0)) << " " << offset.str() << " = scan_carry" << i << "[0];\n";
+        util::spaces(out, 12);
+        out << "for(uint64_t t = 1; t < scan_tid; ++t) {\n";
+        util::spaces(out, 16);
+        jitk::write_operation(*_scans[i], {offset.str(), offset.str(), carry.str()}, out, false);
+        util::spaces(out, 12);
+        out << "}\n";
+    }
+    // And the fix-up of the chunk
+    util::spaces(out, 12);
+    out << "for(uint64_t i0 = scan_begin; i0 < scan_end; ++i0) {\n";
+    for (size_t i = 0; i < _scans.size(); ++i) {
+        const bh_view &view = _scans[i]->operand[0];
+        stringstream output, offset;
+        output << scope.getName(view);
+        write_array_subscription(scope, view, output, true);
+        offset << "scan_offset" << i;
+        util::spaces(out, 16);
+        jitk::write_operation(*_scans[i], {output.str(), offset.str(), output.str()}, out, false);
+    }
+    util::spaces(out, 12);
+    out << "}\n";
+    util::spaces(out, 8);
+    out << "}\n";
+    util::spaces(out, 4);
+    out << "}\n";
+    util::spaces(out, 4);
+    out << "}\n";
+    _scans.clear();
+}
+
+void EngineOpenMP::writeInstr(jitk::Scope &scope, const bh_instruction &instr, int indent, bool opencl,
+                              std::stringstream &out) {
+    for (const jitk::InstrPtr &scan: _scans) {
+        if (scan.get() == &instr) {
+            // The first element of a chunk accumulates onto the identity rather than the preceding chunk
+            const bh_view &view = instr.operand[0];
+            stringstream output, previous, input;
+            output << scope.getName(view);
+            write_array_subscription(scope, view, output);
+            previous << "(i0 == scan_begin ? ";
+            jitk::sweep_identity(instr.opcode, instr.operand_type(0)).pprint(previous, false);
+            previous << " : " << scope.getName(view);
+            write_array_subscription(scope, view, previous, true, BH_MAXDIM, make_pair(instr.sweep_axis(), -1));
+            previous << ")";
+            scope.getName(instr.operand[1], input);
+            if (scope.isArray(instr.operand[1])) {
+                write_array_subscription(scope, instr.operand[1], input);
+            }
+            jitk::write_operation(instr, {output.str(), previous.str(), input.str()}, out, opencl);
+            return;
+        }
+    }
+    auto prefetch_it = _prefetches.find(&instr);
+    if (prefetch_it != _prefetches.end() and _prefetch_rank >= 0) {
+        const Prefetch &prefetch = prefetch_it->second;
+        // NB: an OpenMP atomic or critical directive must precede the instruction itself
+        if (not(scope.isOpenmpAtomic(prefetch.instr) or scope.isOpenmpCritical(prefetch.instr))) {
+            // Gathers read and scatters write the arbitrarily accessed element
+            const bool gather = instr.opcode == BH_GATHER;
+            const bh_view &view = gather ? instr.operand[1] : instr.operand[0];
+            const int rank = static_cast<int>(_prefetch_rank);
+            out << "if (i" << rank << " + " << compiler_prefetch_distance << " < " << _prefetch_end;
+            if (prefetch.sorted_check) { // NB: the unsigned difference of a decreasing index is greater as well
+                out << " && (uint64_t)(" << element_ahead(scope, instr.operand[2], rank, compiler_prefetch_distance)
+                    << " - " << element_ahead(scope, instr.operand[2], rank, 0) << ") > " << compiler_prefetch_distance;
+            }
+            out << ") { ";
+            out << "BH_PREFETCH(&" << scope.getName(view) << "[" << view.start << " + "
+                << element_ahead(scope, instr.operand[2], rank, compiler_prefetch_distance)
+                << "], " << (gather ? 0 : 1) << "); }\n";
+            util::spaces(out, indent);
+        }
+    }
+    for (const Partial &partial: _partials) {
+        if (partial.instr.get() == &instr) {
+            // The reduction updates the partial of the thread rather than the output
+            stringstream input;
+            scope.getName(instr.operand[1], input);
+            if (scope.isArray(instr.operand[1])) {
+                write_array_subscription(scope, instr.operand[1], input);
+            }
+            string output = partial.name;
+            if (not partial.sizes.empty()) {
+                output += "[" + partial_index(partial.sizes) + "]";
+            }
+            jitk::write_operation(instr, {output, input.str()}, out, opencl);
+            return;
+        }
+    }
+    Engine::writeInstr(scope, instr, indent, opencl, out);
+}
+
 void EngineOpenMP::writeKernel(const LoopB &kernel,
                                const jitk::SymbolTable &symbols,
                                const std::vector<bh_base *> &kernel_temps,
@@ -343,15 +1748,56 @@ void EngineOpenMP::writeKernel(const LoopB &kernel,
     ss << "#include <complex.h>\n";
     ss << "#include <tgmath.h>\n";
     ss << "#include <math.h>\n";
+    if (compiler_prefetch_distance > 0) { // The prefetches of gathers and scatters
+        ss << "#if defined(__GNUC__) && !defined(__TINYC__)\n";
+        ss << "#define BH_PREFETCH(addr, rw) __builtin_prefetch(addr, rw)\n";
+        ss << "#else\n";
+        ss << "#define BH_PREFETCH(addr, rw)\n";
+        ss << "#endif\n";
+    }
     if (symbols.useRandom()) { // Write the random function
         ss << "#include <kernel_dependencies/random123_openmp.h>\n";
     }
     writeUnionType(ss); // We always need to declare the union of all constant data types
     ss << "\n";
 
+    // A chunked kernel executes the iterations [chunk_begin, chunk_end) of its outermost loop
+    const LoopB *chunk_loop = execution_pool ? chunkableLoop(kernel) : nullptr;
+
+    // We write the kernel block before the function header since explicitly vectorized loops need the typedefs
+    // of their vector types
+    stringstream body;
+    _simd_typedefs.clear();
+    _num_innermost_loops = 0;
+    _num_simd_loops = 0;
+    _num_scans = 0;
+    _writing_chunked = chunk_loop != nullptr;
+    writeBlock(symbols, nullptr, kernel, {}, false, body);
+    _writing_chunked = false;
+    if (_num_scans > 0) { // Parallel scans query the threads of the parallel region
+        ss << "#include <omp.h>\n\n";
+    }
+    if (compiler_explicit_simd) {
+        for (const auto &simd_typedef: _simd_typedefs) {
+            ss << simd_typedef.second;
+        }
+        ss << "// Explicit SIMD loops: " << _num_simd_loops << " of " << _num_innermost_loops << "\n\n";
+        _simd_loops[codegen_hash] = make_pair(_num_simd_loops, _num_innermost_loops);
+        stat.num_simd_loops += _num_simd_loops;
+        stat.num_innermost_loops += _num_innermost_loops;
+    }
+
     // Write the header of the execute function
     ss << "void execute_" << codegen_hash;
-    writeKernelFunctionArguments(symbols, ss, nullptr);
+    if (chunk_loop == nullptr) {
+        writeKernelFunctionArguments(symbols, ss, nullptr);
+    } else {
+        stringstream args;
+        writeKernelFunctionArguments(symbols, args, nullptr);
+        string args_str = args.str();
+        args_str.pop_back(); // Removing the closing parenthesis
+        ss << args_str << (args_str.size() > 1 ? ", " : "") << "uint64_t chunk_begin, uint64_t chunk_end)";
+    }
 
     // Write the block that makes up the body of 'execute()'
     ss << "{\n";
@@ -362,8 +1808,7 @@ void EngineOpenMP::writeKernel(const LoopB &kernel,
            << ");\n";
     }
     ss << "\n";
-
-    writeBlock(symbols, nullptr, kernel, {}, false, ss);
+    ss << body.str();
 
     // Write frees of the kernel temporaries
     ss << "\n";
@@ -376,18 +1821,15 @@ void EngineOpenMP::writeKernel(const LoopB &kernel,
     // Write the launcher function, which will convert the data_list of void pointers
     // to typed arrays and call the execute function
     {
-        ss << "void launcher_" << codegen_hash
-           << "(void* data_list[], uint64_t offset_strides[], union dtype constants[]) {\n";
+        // We create the typed arrays in `decl`
+        stringstream decl;
         for (size_t i = 0; i < symbols.getParams().size(); ++i) {
-            util::spaces(ss, 4);
+            util::spaces(decl, 4);
             bh_base *b = symbols.getParams()[i];
-            ss << writeType(b->dtype()) << " *a" << symbols.baseID(b);
-            ss << " = data_list[" << i << "];\n";
+            decl << writeType(b->dtype()) << " *a" << symbols.baseID(b);
+            decl << " = data_list[" << i << "];\n";
         }
 
-        util::spaces(ss, 4);
-        ss << "execute_" << codegen_hash << "(";
-
         // We create the comma separated list of args and saves it in `stmp`
         stringstream stmp;
         for (size_t i = 0; i < symbols.getParams().size(); ++i) {
@@ -403,6 +1845,12 @@ void EngineOpenMP::writeKernel(const LoopB &kernel,
             }
         }
 
+        // The loop sizes follows the offset-and-strides
+        const uint64_t loop_sizes_offset = count;
+        for (size_t i = 0; i < symbols.loopSizeBlocks().size(); ++i) {
+            stmp << "offset_strides[" << count++ << "], ";
+        }
+
         if (not symbols.constIDs().empty()) {
             uint64_t i = 0;
             for (auto it = symbols.constIDs().begin(); it != symbols.constIDs().end(); ++it) {
@@ -411,14 +1859,67 @@ void EngineOpenMP::writeKernel(const LoopB &kernel,
             }
         }
 
-        // And then we write `stmp` into `ss` excluding the last comma
-        const string strtmp = stmp.str();
-        if (not strtmp.empty()) {
-            ss << strtmp.substr(0, strtmp.size() - 2);
+        // The args excluding the last comma
+        string args = stmp.str();
+        if (not args.empty()) {
+            args = args.substr(0, args.size() - 2);
+        }
+        const string separator = args.empty() ? "" : ", ";
+
+        ss << "void launcher_" << codegen_hash
+           << "(void* data_list[], uint64_t offset_strides[], union dtype constants[]) {\n";
+        ss << decl.str();
+        util::spaces(ss, 4);
+        ss << "execute_" << codegen_hash << "(" << args;
+        if (chunk_loop != nullptr) { // The whole loop is a single chunk
+            ss << separator << "0, ";
+            if (symbols.existLoopSizeID(*chunk_loop)) {
+                ss << "offset_strides[" << loop_sizes_offset + symbols.loopSizeID(*chunk_loop) << "]";
+            } else {
+                ss << chunk_loop->size;
+            }
         }
         ss << ");\n";
         ss << "}\n";
+
+        // The chunked launcher function, which the execution pool calls with disjoint chunks
+        if (chunk_loop != nullptr) {
+            ss << "\nvoid launcher_" << codegen_hash << "_chunk"
+               << "(void* data_list[], uint64_t offset_strides[], union dtype constants[], "
+               << "uint64_t chunk_begin, uint64_t chunk_end) {\n";
+            ss << decl.str();
+            util::spaces(ss, 4);
+            ss << "execute_" << codegen_hash << "(" << args << separator << "chunk_begin, chunk_end);\n";
+            ss << "}\n";
+        }
+    }
+}
+
+const LoopB *EngineOpenMP::chunkableLoop(const LoopB &kernel) {
+    // The kernel must consist of exactly one loop, which we can split into independent chunks.
+    // NB: kernel-level temporaries and scalar replacements are shared between the iterations of the loop
+    if (not kernel.getLocalTemps().empty()) {
+        return nullptr;
+    }
+    const LoopB *ret = nullptr;
+    for (const Block &b: kernel._block_list) {
+        if (b.isInstr()) {
+            if (b.getInstr() != nullptr and not bh_opcode_is_system(b.getInstr()->opcode)) {
+                return nullptr;
+            }
+        } else if (not b.getLoop().isSystemOnly()) {
+            if (ret != nullptr) {
+                return nullptr;
+            }
+            ret = &b.getLoop();
+        }
+    }
+    // The loop must be parallel without any sweeps (such as reductions) and worth splitting
+    if (ret == nullptr or ret->rank != 0 or ret->size < 2 or not ret->_sweeps.empty() or
+        not openmp_compatible(*ret)) {
+        return nullptr;
     }
+    return ret;
 }
 
 std::string EngineOpenMP::info() const {
@@ -430,17 +1931,58 @@ std::string EngineOpenMP::info() const {
     ss << "  Hardware threads: " << std::thread::hardware_concurrency() << "\n";
     ss << "  Malloc cache limit: " << malloc_cache_limit_in_bytes / 1024 / 1024
        << " MB (" << malloc_cache_limit_in_percent << "% of unused memory)\n";
+    ss << "  Malloc huge pages: " << comp.config.defaultGet<bool>("malloc_hugepage", true) << "\n";
     ss << "  Cache dir: " << comp.config.defaultGet<boost::filesystem::path>("cache_dir", "NONE")  << "\n";
     ss << "  Temp dir: " << jitk::get_tmp_path(comp.config) << "\n";
 
     ss << "  Codegen flags:\n";
     ss << "    OpenMP: " << comp.config.defaultGet<bool>("compiler_openmp", false) << "\n";
     ss << "    OpenMP+SIMD: " << comp.config.defaultGet<bool>("compiler_openmp_simd", false) << "\n";
+    ss << "    OpenMP scan: " << compiler_openmp_scan << "\n";
+    ss << "    OpenMP partials: " << compiler_openmp_partials << " (max elements: "
+       << compiler_openmp_partials_max_elements << ")\n";
+    ss << "    Explicit SIMD: " << compiler_explicit_simd;
+    if (compiler_explicit_simd) {
+        ss << " (" << compiler_simd_width << " bytes";
+        if (not compiler_vector_convert) {
+            ss << ", no type conversions";
+        }
+        ss << ")";
+    }
+    ss << "\n";
+    ss << "    Reduction accumulators: " << compiler_reduction_accumulators;
+    if (compiler_pairwise_sum) {
+        ss << " (pairwise sum)";
+    }
+    ss << "\n";
+    ss << "    Prefetch distance: " << compiler_prefetch_distance;
+    if (compiler_prefetch_distance > 0 and compiler_sorted_index_check) {
+        ss << " (sorted-index check)";
+    }
+    ss << "\n";
     ss << "    Index-as-var: " << comp.config.defaultGet<bool>("index_as_var", true) << "\n";
     ss << "    Strides-as-var: " << comp.config.defaultGet<bool>("strides_as_var", true) << "\n";
     ss << "    Const-as-var: " << comp.config.defaultGet<bool>("const_as_var", true) << "\n";
+    ss << "    Sizes-as-var: " << comp.config.defaultGet<bool>("sizes_as_var", false) << "\n";
 
     ss << "  JIT Command: \"" << compiler.cmd_template << "\"\n";
+    ss << "  JIT Backend: " << (compiler.in_process ? "libtcc" : "subprocess") << "\n";
+    ss << "  JIT Async: " << compiler_async << "\n";
+    ss << "  JIT Interpret Only: " << compiler_interpret_only << "\n";
+    ss << "  JIT Threads: " << _compile_pool->size() << "\n";
+    ss << "  JIT Batch: " << compiler_batch << "\n";
+    ss << "  NUMA policy: " << numa_policy << "\n";
+    ss << "  NUMA pinning: " << comp.config.defaultGet<string>("numa_pinning", "none") << "\n";
+    ss << "  Execution pool: " << execution_pool;
+    if (_execution_pool) {
+        ss << " (" << _execution_pool->size() << " threads)";
+    }
+    ss << "\n";
+    ss << "  Lookahead: " << lookahead;
+    if (lookahead) {
+        ss << " (deadline " << lookahead_deadline << "s)";
+    }
+    ss << "\n";
     return ss.str();
 }
 
@@ -513,12 +2055,13 @@ string EngineOpenMP::userKernel(const std::string &kernel, std::vector<bh_view>
         kernel_with_launcher = ss.str();
     }
 
-    std::string source_filename = jitk::hash_filename(compilation_hash, util::hash(kernel_with_launcher), ".c");
+    const uint64_t hash = sourceHash(kernel_with_launcher, compile_cmd);
+    std::string source_filename = jitk::hash_filename(compilation_hash, hash, ".c");
 
     auto tcompile = chrono::steady_clock::now();
     UserKernelFunction func;
     try {
-        KernelFunction f = getFunction(kernel_with_launcher, "_bh_launcher", compile_cmd);
+        KernelFunction f = getFunction(hash, kernel_with_launcher, "_bh_launcher", compile_cmd);
         func = reinterpret_cast<UserKernelFunction>(f);
         assert(func != nullptr);
     } catch (const std::runtime_error &e) {
@@ -23,6 +23,10 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <iostream>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <future>
+#include <chrono>
 #include <boost/filesystem.hpp>
 
 #include <bohrium/bh_config_parser.hpp>
@@ -32,17 +36,48 @@ If not, see <http://www.gnu.org/licenses/>.
 #include <bohrium/jitk/fuser_cache.hpp>
 #include <bohrium/jitk/codegen_util.hpp>
 #include <bohrium/jitk/codegen_cache.hpp>
+#include <bohrium/jitk/thread_pool.hpp>
+#include <bohrium/jitk/execution_pool.hpp>
+#include <bohrium/jitk/cache_manifest.hpp>
 
 #include <bohrium/jitk/engines/engine_cpu.hpp>
 
 namespace bohrium {
 
 typedef void (*KernelFunction)(void* data_list[], uint64_t offset_strides[], bh_constant_value constants[]);
+typedef void (*ChunkFunction)(void* data_list[], uint64_t offset_strides[], bh_constant_value constants[],
+                              uint64_t chunk_begin, uint64_t chunk_end);
 typedef void (*UserKernelFunction)(void* data_list[]);
 
 class EngineOpenMP : public jitk::EngineCPU {
 private:
+    // Everything needed to launch a kernel, which we reuse between launches of the same kernel
+    struct LaunchDescriptor {
+        uint64_t hash = 0;                // Hash of the kernel source
+        KernelFunction func = nullptr;    // The launcher function (nullptr while compiling in the background)
+        ChunkFunction chunk_func = nullptr; // The chunked launcher function (nullptr if the kernel has none)
+        bool chunkable = false;           // Can the execution pool split the outermost loop of the kernel?
+        bool first_touch = false;         // Should new arrays of the kernel be first-touched in parallel?
+        std::string func_name;            // Name of the launcher function
+        // The key of the kernel in `stat.time_per_kernel`. NB: we look up the statistics at each launch
+        // since a reset of the statistics replaces `stat`
+        std::string stats_key;
+        uint64_t num_simd_loops = 0;      // Number of explicitly vectorized innermost loops
+        uint64_t num_innermost_loops = 0; // Number of innermost loops
+        // The argument buffers of the launcher function
+        std::vector<void *> data_list;
+        std::vector<uint64_t> offset_and_strides;
+        std::vector<bh_constant_value> constant_arg;
+    };
+    // The launch descriptors (key: codegen hash)
+    std::unordered_map<uint64_t, LaunchDescriptor> _launches;
+
+    // Register the execution time `texec` of the kernel of `launch` in the per-kernel statistics
+    void registerExecTime(const LaunchDescriptor &launch, std::chrono::steady_clock::duration texec);
+
     std::map<uint64_t, KernelFunction> _functions;
+    // The chunked launcher functions of the kernels in `_functions` that have one
+    std::map<uint64_t, ChunkFunction> _chunk_functions;
     std::vector<void*> _lib_handles;
 
     // The compiler to use when function doesn't exist
@@ -52,21 +87,204 @@ private:
     const bool compiler_openmp;
     // Generate SIMD code?
     const bool compiler_openmp_simd;
+    // Generate parallel scans of the accumulations of one-dimensional loops?
+    const bool compiler_openmp_scan;
+    // Combine the reductions of the outermost parallel loop that OpenMP cannot express from thread-private partials?
+    const bool compiler_openmp_partials;
+    // The maximum number of elements of the output of a reduction that is combined from thread-private partials
+    const int64_t compiler_openmp_partials_max_elements;
+    // Generate explicitly vectorized innermost loops using the GCC vector extensions?
+    const bool compiler_explicit_simd;
+    // Does the compiler support `__builtin_convertvector`, which the explicit SIMD loops use for type conversions?
+    const bool compiler_vector_convert;
+    // The size in bytes of the vectors of the explicitly vectorized loops
+    const int64_t compiler_simd_width;
+    // The number of independent accumulators of each reduction in an innermost loop
+    const int64_t compiler_reduction_accumulators;
+    // Sum the floating-point add-reductions of the innermost loops pairwise?
+    const bool compiler_pairwise_sum;
+    // Number of iterations ahead that the gathers and scatters of innermost loops prefetch their arbitrarily
+    // accessed element (zero disables prefetching)
+    const int64_t compiler_prefetch_distance;
+    // Check at runtime whether the index arrays of the prefetching gathers and scatters are sorted, in which case
+    // the accesses stream through memory and the prefetches are skipped
+    const bool compiler_sorted_index_check;
+    // The typedefs of the vector types used by the kernel being written (key: type name, value: typedef)
+    std::map<std::string, std::string> _simd_typedefs;
+    // The number of innermost loops and explicitly vectorized loops of the kernel being written
+    uint64_t _num_innermost_loops = 0;
+    uint64_t _num_simd_loops = 0;
+    // The number of innermost loops and explicitly vectorized loops of each kernel (key: codegen hash)
+    std::map<uint64_t, std::pair<uint64_t, uint64_t> > _simd_loops;
+
+    // Return the number of lanes of the explicitly vectorized version of the innermost loop `block` or
+    // zero (and the reason in `reason`) when the loop cannot be vectorized explicitly
+    int64_t simdLanes(const jitk::SymbolTable &symbols,
+                      const jitk::Scope &scope,
+                      const jitk::LoopB &block,
+                      std::string &reason) const;
+
+    // Should the reductions of the innermost loop `block`, which isn't vectorized explicitly, accumulate into
+    // multiple scalars (or be summed pairwise)?
+    bool scalarAccumulators(const jitk::SymbolTable &symbols,
+                            const jitk::Scope &scope,
+                            const jitk::LoopB &block) const;
+
+    // Return the vector type of `lanes` elements of `dtype` and register its typedef in `_simd_typedefs`
+    std::string simdType(bh_type dtype, int64_t lanes);
+
+    // Write the explicitly vectorized loop of the innermost loop `block`, which executes the iterations from
+    // `begin` up to the largest multiple of `lanes` (times the number of reduction accumulators) before `end`.
+    // One lane writes scalar operations, which only makes sense for the reduction accumulators.
+    // Returns the first iteration of the remainder.
+    std::string writeSimdLoop(const jitk::SymbolTable &symbols,
+                              jitk::Scope &scope,
+                              const jitk::LoopB &block,
+                              int64_t lanes,
+                              const std::string &begin,
+                              const std::string &end,
+                              std::stringstream &out);
+
+    // Compile kernels in the background and interpret them while the compilation is pending?
+    const bool compiler_async;
+    // Interpret all kernels that the interpreter supports rather than compiling them?
+    const bool compiler_interpret_only;
+    // The threads that compile kernels in parallel and in the background
+    std::unique_ptr<jitk::ThreadPool> _compile_pool;
+    // Kernels being compiled by `_compile_pool` (key: source hash, value: the resulting shared library)
+    std::map<uint64_t, std::shared_future<boost::filesystem::path> > _pending;
+
+    // Compile all new kernels of a flush into one shared library?
+    const bool compiler_batch;
+    // Execute the outermost parallel loop of kernels in `_execution_pool` rather than in an OpenMP parallel region?
+    const bool execution_pool;
+    // The persistent threads that execute the chunked kernels (nullptr when `execution_pool` is disabled)
+    std::unique_ptr<jitk::ExecutionPool> _execution_pool;
+    // True while `writeKernel()` writes a chunked kernel, which makes the outermost loop iterate over a chunk
+    bool _writing_chunked = false;
+
+    // A thread-private partial result of a reduction in the outermost parallel loop, which the thread combines with
+    // the output of the reduction after the loop. The reductions that OpenMP cannot express as `reduction(op:var)`
+    // use partials rather than guarding each update of the output with OpenMP atomic or critical.
+    struct Partial {
+        jitk::InstrPtr instr;
+        // The variable of the partial result, which is an array when the output isn't a scalar
+        std::string name;
+        // The sizes of the loops that iterate over the output (the loops that enclose `instr` excl. the outermost)
+        std::vector<std::string> sizes;
+    };
+    // The partials of the outermost loop being written
+    std::vector<Partial> _partials;
+
+    // The accumulations of the parallel scan being written. In a parallel scan, each thread scans a chunk of the
+    // loop starting at the identity, then the threads exchange the last element of their chunks (the carries),
+    // and finally each thread combines the carries of the preceding chunks with its chunk (the fix-up).
+    std::vector<jitk::InstrPtr> _scans;
+    // The number of parallel scans of the kernel being written, which query the threads using the OpenMP API
+    uint64_t _num_scans = 0;
+
+    // Return true when the outermost loop `block` can be written as a parallel scan, which requires a
+    // one-dimensional loop where all sweeps are add or multiply accumulations that no other instruction accesses
+    bool scanCompatible(const jitk::Scope &scope, const jitk::LoopB &block) const;
+
+    // Write the carry exchange and the fix-up pass of the parallel scan, which closes the parallel region
+    void writeScanTail(jitk::Scope &scope, std::stringstream &out);
+
+    // A gather or scatter of the innermost loop being written that prefetches its arbitrarily accessed element
+    struct Prefetch {
+        jitk::InstrPtr instr;
+        // Skip the prefetch when the index ahead is at most `compiler_prefetch_distance` elements after the index of
+        // the current iteration, which is the case for sorted dense indices that stream through memory
+        bool sorted_check = false;
+    };
+    // The prefetches of the innermost loop being written (key: the gather or scatter)
+    std::map<const bh_instruction *, Prefetch> _prefetches;
+    // The rank and the iteration end of the innermost loop being written, which the prefetches must stay within
+    int64_t _prefetch_rank = -1;
+    std::string _prefetch_end;
+
+    // Find the gathers and scatters of the innermost loop `block` that should prefetch
+    void findPrefetches(const jitk::Scope &scope, const jitk::LoopB &block);
+
+    // Return the loop that a chunked version of `kernel` splits or nullptr if `kernel` cannot be chunked
+    static const jitk::LoopB *chunkableLoop(const jitk::LoopB &kernel);
+
+    // The NUMA page placement of new arrays: `none`, `first_touch`, or `interleave`
+    const std::string numa_policy;
+    // True while `execute()` allocates the arrays of a kernel that should be first-touched in parallel
+    bool _numa_first_touch = false;
+    // The function that touches the pages of a new data region in parallel (nullptr until first used)
+    KernelFunction _numa_touch_func = nullptr;
+    // The NUMA nodes that `numa_policy` interleaves the pages between (see `numa::node_mask()`)
+    std::vector<unsigned long> _numa_node_mask;
+
+    // Place the pages of the new data region [mem, mem+nbytes) according to `numa_policy`
+    void numaPlacement(void *mem, uint64_t nbytes);
+
+    // Pin the OpenMP threads to the CPUs in the order given by `pinning` (see `numa::pinning_order()`)
+    void numaPinning(const std::string &pinning);
+
+    // The manifest of the kernels in the cache dir (nullptr when the cache is disabled)
+    std::unique_ptr<jitk::CacheManifest> _manifest;
+    // The libraries compiled by this process (key: library hash, value: the kernels and their symbols)
+    std::map<uint64_t, std::vector<std::pair<uint64_t, std::string> > > _new_libraries;
+
+    // File that records the kernels used in a run, which are pre-loaded at the next start (empty when disabled)
+    const boost::filesystem::path kernel_trace;
+    // The kernels used in this run (key: source hash, value: symbol and source), which we write to `kernel_trace`
+    std::map<uint64_t, std::pair<std::string, std::string> > _trace;
+
+    // Load the kernels in `kernel_trace` from the cache and start compiling the ones missing
+    void prewarm();
+
+    // Write the kernels used in this run to `kernel_trace`
+    void writeTrace() const;
+
+    // Return the hash of the kernel `source` compiled using `compile_cmd` (empty means `compiler_cmd`). The kernels
+    // that the in-process compiler compiles get other hashes than the kernels compiled by `compiler_cmd`, thus the
+    // cache dir keeps both and `compilation_hash` stays the hash of `compiler_cmd`.
+    uint64_t sourceHash(const std::string &source, const std::string &compile_cmd = "") const;
+
+    // Return the path to the shared library in the cache dir that implements `hash` or the empty path
+    boost::filesystem::path cachedLibrary(uint64_t hash);
+
+    // Compile `source`, which has the hash `hash`, into a shared library in the tmp dir and return its path
+    // NB: this function is called by the threads in `_compile_pool` thus it must not modify the engine
+    boost::filesystem::path compileFunction(uint64_t hash, const std::string &source,
+                                            const std::string &compile_cmd) const;
+
+    // Load the function `func_name` from `lib_handle` and register it in `_functions` under `hash`
+    KernelFunction loadFunction(uint64_t hash, void *lib_handle, const std::string &func_name);
+
+    // Wait for the pending compilation of `hash` and load `func_name` from the result
+    KernelFunction loadPendingFunction(uint64_t hash, const std::string &func_name);
 
 public:
     // Return a kernel function based on the given 'source' and the name of the kernel function
     KernelFunction getFunction(const std::string &source, const std::string &func_name,
                                const std::string &compile_cmd = "");
 
+    // Like `getFunction()` but with the hash of `source` already computed
+    KernelFunction getFunction(uint64_t hash, const std::string &source, const std::string &func_name,
+                               const std::string &compile_cmd = "");
+
+    // Like `getFunction()` but the compilation happens in the background.
+    // Returns nullptr while the compilation of `source` (which has the hash `hash`) is pending.
+    KernelFunction getFunctionAsync(uint64_t hash, const std::string &source, const std::string &func_name);
+
     EngineOpenMP(component::ComponentVE &comp, jitk::Statistics &stat);
 
     ~EngineOpenMP() override;
 
-    void execute(const jitk::SymbolTable &symbols,
+    void execute(const jitk::LoopB &kernel,
+                 const jitk::SymbolTable &symbols,
                  const std::string &source,
                  uint64_t codegen_hash,
                  const std::vector<const bh_instruction*> &constants) override;
 
+    // Start compiling all of `sources` in `_compile_pool`, `execute()` will wait for them when needed
+    void compileAhead(const std::vector<std::pair<std::string, uint64_t> > &sources) override;
+
     void writeKernel(const jitk::LoopB &kernel,
                      const jitk::SymbolTable &symbols,
                      const std::vector<bh_base *> &kernel_temps,
@@ -85,6 +303,14 @@ public:
                         const std::vector<uint64_t> &thread_stack,
                         std::stringstream &out) override;
 
+    void loopTailWriter(const jitk::SymbolTable &symbols,
+                        jitk::Scope &scope,
+                        const jitk::LoopB &block,
+                        std::stringstream &out) override;
+
+    void writeInstr(jitk::Scope &scope, const bh_instruction &instr, int indent, bool opencl,
+                    std::stringstream &out) override;
+
     // Return a YAML string describing this component
     std::string info() const override;
 
@@ -92,9 +318,7 @@ public:
     const std::string writeType(bh_type dtype) override;
 
     // Update statistics with final aggregated values of the engine
-    void updateFinalStatistics() override {
-        bh_get_malloc_cache_stat(stat.malloc_cache_lookups, stat.malloc_cache_misses, stat.max_memory_usage);
-    }
+    void updateFinalStatistics() override;
 
     std::string userKernel(const std::string &kernel, std::vector<bh_view> &operand_list,
                            const std::string &compile_cmd, const std::string &tag, const std::string &param);
@@ -102,6 +326,8 @@ public:
 private:
     // Writes the union of C99 types that can make up a constant
     inline void writeUnionType(std::stringstream& out) {
+        // NB: the guard makes it possible to combine multiple kernels into one translation unit
+        out << "\n#ifndef BH_UNION_DTYPE\n#define BH_UNION_DTYPE";
         out << "\ntypedef struct { uint64_t x, y; } r123_t" << ";\n";
         out << "union dtype {\n";
         util::spaces(out, 4); out << writeType(bh_type::BOOL)       << " " << bh_type_text(bh_type::BOOL)       << ";\n";
@@ -119,6 +345,7 @@ private:
         util::spaces(out, 4); out << writeType(bh_type::COMPLEX128) << " " << bh_type_text(bh_type::COMPLEX128) << ";\n";
         util::spaces(out, 4); out << writeType(bh_type::R123)       << " " << bh_type_text(bh_type::R123)       << ";\n";
         out << "};\n";
+        out << "#endif\n";
     }
 };
 } // bohrium
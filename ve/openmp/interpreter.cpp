@@ -0,0 +1,567 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+#include <bohrium/bh_opcode.h>
+#include <bohrium/bh_main_memory.hpp>
+#include <bohrium/jitk/iterator.hpp>
+
+#include "interpreter.hpp"
+
+using namespace std;
+
+namespace bohrium {
+namespace interpreter {
+
+namespace { // We need some help functions
+
+// Load element `offset` of `data`, which has the type `dtype`, and convert it to a `T`
+template<typename T>
+T load(bh_type dtype, const void *data, int64_t offset) {
+    switch (dtype) {
+        case bh_type::BOOL:
+            return static_cast<T>(static_cast<const bh_bool *>(data)[offset] != 0);
+        case bh_type::INT8:
+            return static_cast<T>(static_cast<const int8_t *>(data)[offset]);
+        case bh_type::INT16:
+            return static_cast<T>(static_cast<const int16_t *>(data)[offset]);
+        case bh_type::INT32:
+            return static_cast<T>(static_cast<const int32_t *>(data)[offset]);
+        case bh_type::INT64:
+            return static_cast<T>(static_cast<const int64_t *>(data)[offset]);
+        case bh_type::UINT8:
+            return static_cast<T>(static_cast<const uint8_t *>(data)[offset]);
+        case bh_type::UINT16:
+            return static_cast<T>(static_cast<const uint16_t *>(data)[offset]);
+        case bh_type::UINT32:
+            return static_cast<T>(static_cast<const uint32_t *>(data)[offset]);
+        case bh_type::UINT64:
+            return static_cast<T>(static_cast<const uint64_t *>(data)[offset]);
+        case bh_type::FLOAT32:
+            return static_cast<T>(static_cast<const float *>(data)[offset]);
+        case bh_type::FLOAT64:
+            return static_cast<T>(static_cast<const double *>(data)[offset]);
+        default:
+            throw runtime_error("interpreter: unsupported data type");
+    }
+}
+
+// Convert `value` to the type `dtype` and store it at element `offset` of `data`
+template<typename T>
+void store(bh_type dtype, void *data, int64_t offset, T value) {
+    switch (dtype) {
+        case bh_type::BOOL:
+            static_cast<bh_bool *>(data)[offset] = static_cast<bool>(value);
+            return;
+        case bh_type::INT8:
+            static_cast<int8_t *>(data)[offset] = static_cast<int8_t>(value);
+            return;
+        case bh_type::INT16:
+            static_cast<int16_t *>(data)[offset] = static_cast<int16_t>(value);
+            return;
+        case bh_type::INT32:
+            static_cast<int32_t *>(data)[offset] = static_cast<int32_t>(value);
+            return;
+        case bh_type::INT64:
+            static_cast<int64_t *>(data)[offset] = static_cast<int64_t>(value);
+            return;
+        case bh_type::UINT8:
+            static_cast<uint8_t *>(data)[offset] = static_cast<uint8_t>(value);
+            return;
+        case bh_type::UINT16:
+            static_cast<uint16_t *>(data)[offset] = static_cast<uint16_t>(value);
+            return;
+        case bh_type::UINT32:
+            static_cast<uint32_t *>(data)[offset] = static_cast<uint32_t>(value);
+            return;
+        case bh_type::UINT64:
+            static_cast<uint64_t *>(data)[offset] = static_cast<uint64_t>(value);
+            return;
+        case bh_type::FLOAT32:
+            static_cast<float *>(data)[offset] = static_cast<float>(value);
+            return;
+        case bh_type::FLOAT64:
+            static_cast<double *>(data)[offset] = static_cast<double>(value);
+            return;
+        default:
+            throw runtime_error("interpreter: unsupported data type");
+    }
+}
+
+// Returns the value of the constant `c` converted to a `T`
+// NB: all members of `bh_constant_value` are located at the beginning of the union
+template<typename T>
+T constant_as(const bh_constant &c) {
+    return load<T>(c.type, &c.value, 0);
+}
+
+// Returns the element-wise opcode that a sweep opcode applies
+bh_opcode sweep2elementwise(bh_opcode opcode) {
+    switch (opcode) {
+        case BH_ADD_REDUCE:
+        case BH_ADD_ACCUMULATE:
+            return BH_ADD;
+        case BH_MULTIPLY_REDUCE:
+        case BH_MULTIPLY_ACCUMULATE:
+            return BH_MULTIPLY;
+        case BH_MINIMUM_REDUCE:
+            return BH_MINIMUM;
+        case BH_MAXIMUM_REDUCE:
+            return BH_MAXIMUM;
+        case BH_LOGICAL_AND_REDUCE:
+            return BH_LOGICAL_AND;
+        case BH_LOGICAL_OR_REDUCE:
+            return BH_LOGICAL_OR;
+        case BH_LOGICAL_XOR_REDUCE:
+            return BH_LOGICAL_XOR;
+        case BH_BITWISE_AND_REDUCE:
+            return BH_BITWISE_AND;
+        case BH_BITWISE_OR_REDUCE:
+            return BH_BITWISE_OR;
+        case BH_BITWISE_XOR_REDUCE:
+            return BH_BITWISE_XOR;
+        default:
+            throw runtime_error("interpreter: unsupported sweep operation");
+    }
+}
+
+// Is `opcode` an element-wise operation supported by `apply()`?
+bool supported_elementwise(bh_opcode opcode) {
+    switch (opcode) {
+        case BH_ADD: case BH_SUBTRACT: case BH_MULTIPLY: case BH_DIVIDE: case BH_POWER: case BH_ABSOLUTE:
+        case BH_GREATER: case BH_GREATER_EQUAL: case BH_LESS: case BH_LESS_EQUAL: case BH_EQUAL:
+        case BH_NOT_EQUAL: case BH_LOGICAL_AND: case BH_LOGICAL_OR: case BH_LOGICAL_XOR: case BH_LOGICAL_NOT:
+        case BH_MAXIMUM: case BH_MINIMUM: case BH_BITWISE_AND: case BH_BITWISE_OR: case BH_BITWISE_XOR:
+        case BH_INVERT: case BH_LEFT_SHIFT: case BH_RIGHT_SHIFT: case BH_COS: case BH_SIN: case BH_TAN:
+        case BH_COSH: case BH_SINH: case BH_TANH: case BH_ARCSIN: case BH_ARCCOS: case BH_ARCTAN:
+        case BH_ARCSINH: case BH_ARCCOSH: case BH_ARCTANH: case BH_ARCTAN2: case BH_EXP: case BH_EXP2:
+        case BH_EXPM1: case BH_LOG: case BH_LOG2: case BH_LOG10: case BH_LOG1P: case BH_SQRT: case BH_CEIL:
+        case BH_TRUNC: case BH_FLOOR: case BH_RINT: case BH_MOD: case BH_REMAINDER: case BH_ISNAN:
+        case BH_ISINF: case BH_ISFINITE: case BH_SIGN: case BH_IDENTITY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Returns the absolute value of `a`, which is `a` itself for unsigned types (including bool)
+template<typename T>
+typename enable_if<is_unsigned<T>::value, T>::type absolute(T a) {
+    return a;
+}
+template<typename T>
+typename enable_if<not is_unsigned<T>::value, T>::type absolute(T a) {
+    return a < 0 ? static_cast<T>(-a) : a;
+}
+
+// Returns the sign (-1, 0, or 1) of `a`, which is never negative for unsigned types (including bool)
+template<typename T>
+typename enable_if<is_unsigned<T>::value, T>::type sign(T a) {
+    return static_cast<T>(a != T());
+}
+template<typename T>
+typename enable_if<not is_unsigned<T>::value, T>::type sign(T a) {
+    return static_cast<T>((a > 0) - (0 > a));
+}
+
+// Apply the element-wise `opcode` on `a` and `b` (`b` is ignored by unary operations)
+// The semantic matches the C99 code written by `jitk::write_operation()`
+template<typename T>
+T apply(bh_opcode opcode, T a, T b) {
+    // Integer and floating point versions of `T`, which makes all operations compile for all types
+    typedef typename conditional<is_integral<T>::value and not is_same<T, bool>::value, T, int64_t>::type IntT;
+    typedef typename conditional<is_floating_point<T>::value, T, double>::type FltT;
+    const bool is_float = is_floating_point<T>::value;
+    const bool is_signed_int = is_integral<T>::value and is_signed<T>::value;
+
+    switch (opcode) {
+        case BH_IDENTITY:
+            return a;
+        case BH_ADD:
+            return static_cast<T>(a + b);
+        case BH_SUBTRACT:
+            return static_cast<T>(a - b);
+        case BH_MULTIPLY:
+            return static_cast<T>(a * b);
+        case BH_DIVIDE:
+            if (is_signed_int) { // Python/NumPy signed integer division
+                const IntT x = static_cast<IntT>(a), y = static_cast<IntT>(b);
+                return static_cast<T>(((x > 0) != (y > 0) and (x % y) != 0) ? (x / y - 1) : (x / y));
+            }
+            return static_cast<T>(a / b);
+        case BH_POWER:
+            return static_cast<T>(pow(static_cast<FltT>(a), static_cast<FltT>(b)));
+        case BH_ABSOLUTE:
+            return absolute(a);
+        case BH_GREATER:
+            return static_cast<T>(a > b);
+        case BH_GREATER_EQUAL:
+            return static_cast<T>(a >= b);
+        case BH_LESS:
+            return static_cast<T>(a < b);
+        case BH_LESS_EQUAL:
+            return static_cast<T>(a <= b);
+        case BH_EQUAL:
+            return static_cast<T>(a == b);
+        case BH_NOT_EQUAL:
+            return static_cast<T>(a != b);
+        case BH_LOGICAL_AND:
+            return static_cast<T>(a and b);
+        case BH_LOGICAL_OR:
+            return static_cast<T>(a or b);
+        case BH_LOGICAL_XOR:
+            return static_cast<T>(not a != not b);
+        case BH_LOGICAL_NOT:
+            return static_cast<T>(not a);
+        case BH_MAXIMUM:
+            return a > b ? a : b;
+        case BH_MINIMUM:
+            return a < b ? a : b;
+        case BH_BITWISE_AND:
+            return static_cast<T>(static_cast<IntT>(a) & static_cast<IntT>(b));
+        case BH_BITWISE_OR:
+            return static_cast<T>(static_cast<IntT>(a) | static_cast<IntT>(b));
+        case BH_BITWISE_XOR:
+            return static_cast<T>(static_cast<IntT>(a) ^ static_cast<IntT>(b));
+        case BH_INVERT:
+            if (is_same<T, bool>::value) {
+                return static_cast<T>(not a);
+            }
+            return static_cast<T>(~static_cast<IntT>(a));
+        case BH_LEFT_SHIFT:
+            return static_cast<T>(static_cast<IntT>(a) << static_cast<IntT>(b));
+        case BH_RIGHT_SHIFT:
+            return static_cast<T>(static_cast<IntT>(a) >> static_cast<IntT>(b));
+        case BH_MOD:
+            if (is_float) {
+                return static_cast<T>(fmod(static_cast<FltT>(a), static_cast<FltT>(b)));
+            }
+            return static_cast<T>(static_cast<IntT>(a) % static_cast<IntT>(b));
+        case BH_REMAINDER:
+            if (is_float) {
+                return static_cast<T>(a - floor(static_cast<FltT>(a) / static_cast<FltT>(b)) * b);
+            } else if (is_signed_int) { // Python/NumPy signed integer remainder
+                const IntT x = static_cast<IntT>(a), y = static_cast<IntT>(b);
+                return static_cast<T>(((x > 0) == (y > 0) or (x % y) == 0) ? (x % y) : (x % y) + y);
+            }
+            return static_cast<T>(static_cast<IntT>(a) % static_cast<IntT>(b));
+        case BH_COS:
+            return static_cast<T>(cos(static_cast<FltT>(a)));
+        case BH_SIN:
+            return static_cast<T>(sin(static_cast<FltT>(a)));
+        case BH_TAN:
+            return static_cast<T>(tan(static_cast<FltT>(a)));
+        case BH_COSH:
+            return static_cast<T>(cosh(static_cast<FltT>(a)));
+        case BH_SINH:
+            return static_cast<T>(sinh(static_cast<FltT>(a)));
+        case BH_TANH:
+            return static_cast<T>(tanh(static_cast<FltT>(a)));
+        case BH_ARCSIN:
+            return static_cast<T>(asin(static_cast<FltT>(a)));
+        case BH_ARCCOS:
+            return static_cast<T>(acos(static_cast<FltT>(a)));
+        case BH_ARCTAN:
+            return static_cast<T>(atan(static_cast<FltT>(a)));
+        case BH_ARCSINH:
+            return static_cast<T>(asinh(static_cast<FltT>(a)));
+        case BH_ARCCOSH:
+            return static_cast<T>(acosh(static_cast<FltT>(a)));
+        case BH_ARCTANH:
+            return static_cast<T>(atanh(static_cast<FltT>(a)));
+        case BH_ARCTAN2:
+            return static_cast<T>(atan2(static_cast<FltT>(a), static_cast<FltT>(b)));
+        case BH_EXP:
+            return static_cast<T>(exp(static_cast<FltT>(a)));
+        case BH_EXP2:
+            return static_cast<T>(exp2(static_cast<FltT>(a)));
+        case BH_EXPM1:
+            return static_cast<T>(expm1(static_cast<FltT>(a)));
+        case BH_LOG:
+            return static_cast<T>(log(static_cast<FltT>(a)));
+        case BH_LOG2:
+            return static_cast<T>(log2(static_cast<FltT>(a)));
+        case BH_LOG10:
+            return static_cast<T>(log10(static_cast<FltT>(a)));
+        case BH_LOG1P:
+            return static_cast<T>(log1p(static_cast<FltT>(a)));
+        case BH_SQRT:
+            return static_cast<T>(sqrt(static_cast<FltT>(a)));
+        case BH_CEIL:
+            return static_cast<T>(ceil(static_cast<FltT>(a)));
+        case BH_TRUNC:
+            return static_cast<T>(trunc(static_cast<FltT>(a)));
+        case BH_FLOOR:
+            return static_cast<T>(floor(static_cast<FltT>(a)));
+        case BH_RINT:
+            return static_cast<T>(rint(static_cast<FltT>(a)));
+        case BH_ISNAN:
+            return static_cast<T>(std::isnan(static_cast<FltT>(a)));
+        case BH_ISINF:
+            return static_cast<T>(std::isinf(static_cast<FltT>(a)));
+        case BH_ISFINITE:
+            return static_cast<T>(std::isfinite(static_cast<FltT>(a)));
+        case BH_SIGN:
+            return sign(a);
+        default:
+            throw runtime_error("interpreter: unsupported operation");
+    }
+}
+
+// Calls `func(coord, offsets)` for each coordinate `coord` in `shape` where `offsets[i]` is the element offset
+// of `views[i]` at `coord`. NB: all views must have the same number of dimensions as `shape` and constants
+// always get the offset zero.
+template<typename Func>
+void for_each_element(const BhIntVec &shape, const vector<bh_view> &views, Func func) {
+    const int64_t ndim = static_cast<int64_t>(shape.size());
+    if (shape.prod() <= 0) {
+        return;
+    }
+    vector<int64_t> coord(static_cast<size_t>(ndim), 0);
+    vector<int64_t> offsets(views.size(), 0);
+    for (size_t i = 0; i < views.size(); ++i) {
+        if (not views[i].isConstant()) {
+            assert(views[i].ndim == ndim);
+            offsets[i] = views[i].start;
+        }
+    }
+    while (true) {
+        func(coord, offsets);
+        // Let's increment the coordinate (and offsets) like an odometer
+        int64_t d = ndim - 1;
+        for (; d >= 0; --d) {
+            ++coord[d];
+            for (size_t i = 0; i < views.size(); ++i) {
+                if (not views[i].isConstant()) {
+                    offsets[i] += views[i].stride[d];
+                }
+            }
+            if (coord[d] < shape[d]) {
+                break;
+            }
+            for (size_t i = 0; i < views.size(); ++i) {
+                if (not views[i].isConstant()) {
+                    offsets[i] -= views[i].stride[d] * shape[d];
+                }
+            }
+            coord[d] = 0;
+        }
+        if (d < 0) {
+            return;
+        }
+    }
+}
+
+// Returns the output view of a reduction with the reduced axis re-inserted (using a zero stride),
+// which makes the output view align with the input view `in`
+bh_view align_reduction_output(const bh_view &out, const bh_view &in, int axis) {
+    bh_view ret(out);
+    if (out.ndim == in.ndim - 1) {
+        ret.shape.insert(ret.shape.begin() + axis, in.shape[axis]);
+        ret.stride.insert(ret.stride.begin() + axis, 0);
+        ++ret.ndim;
+    } else { // Reducing a vector to a scalar
+        assert(out.is_scalar());
+        ret.ndim = in.ndim;
+        ret.shape = in.shape;
+        ret.stride = BhIntVec(static_cast<size_t>(in.ndim), 0);
+    }
+    return ret;
+}
+
+// Returns the type the operation of `instr` is computed in
+bh_type compute_type(const bh_instruction &instr) {
+    if (instr.opcode == BH_RANGE) {
+        return instr.operand[0].base->dtype();
+    }
+    return instr.operand_type(1);
+}
+
+// Execute `instr` computing in the type `T`
+template<typename T>
+void execute_instr(const bh_instruction &instr) {
+    const bh_view &out = instr.operand[0];
+    const bh_type out_dtype = out.base->dtype();
+    void *out_data = out.base->getDataPtr();
+
+    if (bh_opcode_is_reduction(instr.opcode)) {
+        const bh_view &in = instr.operand[1];
+        const bh_type in_dtype = in.base->dtype();
+        const void *in_data = in.base->getDataPtr();
+        const bh_opcode opcode = sweep2elementwise(instr.opcode);
+        const vector<bh_view> views = {align_reduction_output(out, in, instr.sweep_axis()), in};
+        for_each_element(in.shape, views, [&](const vector<int64_t> &coord, const vector<int64_t> &offsets) {
+            const T a = load<T>(out_dtype, out_data, offsets[0]);
+            const T b = load<T>(in_dtype, in_data, offsets[1]);
+            store<T>(out_dtype, out_data, offsets[0], apply<T>(opcode, a, b));
+        });
+    } else if (bh_opcode_is_accumulate(instr.opcode)) {
+        // NB: the first element along the sweep axis has been initiated with the identity value
+        const bh_view &in = instr.operand[1];
+        const bh_type in_dtype = in.base->dtype();
+        const void *in_data = in.base->getDataPtr();
+        const bh_opcode opcode = sweep2elementwise(instr.opcode);
+        const int axis = instr.sweep_axis();
+        const vector<bh_view> views = {out, in};
+        for_each_element(in.shape, views, [&](const vector<int64_t> &coord, const vector<int64_t> &offsets) {
+            const int64_t prev = coord[axis] > 0 ? offsets[0] - out.stride[axis] : offsets[0];
+            const T a = load<T>(out_dtype, out_data, prev);
+            const T b = load<T>(in_dtype, in_data, offsets[1]);
+            store<T>(out_dtype, out_data, offsets[0], apply<T>(opcode, a, b));
+        });
+    } else if (instr.opcode == BH_GATHER) { // out[<coord>] = in1[in1.start + in2[<coord>]]
+        const bh_view &in = instr.operand[1];
+        const bh_view &idx = instr.operand[2];
+        const vector<bh_view> views = {out, idx};
+        for_each_element(idx.shape, views, [&](const vector<int64_t> &coord, const vector<int64_t> &offsets) {
+            const int64_t i = load<int64_t>(idx.base->dtype(), idx.base->getDataPtr(), offsets[1]);
+            const T value = load<T>(in.base->dtype(), in.base->getDataPtr(), in.start + i);
+            store<T>(out_dtype, out_data, offsets[0], value);
+        });
+    } else if (instr.opcode == BH_SCATTER or instr.opcode == BH_COND_SCATTER) { // out[out.start + in2[<coord>]] = in1[<coord>]
+        const bh_view &in = instr.operand[1];
+        const bh_view &idx = instr.operand[2];
+        vector<bh_view> views = {in, idx};
+        if (instr.opcode == BH_COND_SCATTER) {
+            views.push_back(instr.operand[3]);
+        }
+        for_each_element(idx.shape, views, [&](const vector<int64_t> &coord, const vector<int64_t> &offsets) {
+            if (views.size() > 2 and not load<bool>(views[2].base->dtype(), views[2].base->getDataPtr(), offsets[2])) {
+                return;
+            }
+            const int64_t i = load<int64_t>(idx.base->dtype(), idx.base->getDataPtr(), offsets[1]);
+            const T value = load<T>(in.base->dtype(), in.base->getDataPtr(), offsets[0]);
+            store<T>(out_dtype, out_data, out.start + i, value);
+        });
+    } else if (instr.opcode == BH_RANGE) { // Like the generated code, we use the flat index of the output
+        const vector<bh_view> views = {out};
+        for_each_element(out.shape, views, [&](const vector<int64_t> &coord, const vector<int64_t> &offsets) {
+            store<T>(out_dtype, out_data, offsets[0], static_cast<T>(offsets[0]));
+        });
+    } else {
+        assert(supported_elementwise(instr.opcode));
+        // Constants are loaded once and arrays are loaded at each element
+        vector<T> constants(instr.operand.size(), T());
+        for (size_t i = 1; i < instr.operand.size(); ++i) {
+            if (instr.operand[i].isConstant()) {
+                constants[i] = constant_as<T>(instr.constant);
+            }
+        }
+        const vector<bh_view> &views = instr.operand;
+        for_each_element(out.shape, views, [&](const vector<int64_t> &coord, const vector<int64_t> &offsets) {
+            T ops[3] = {T(), T(), T()};
+            for (size_t i = 1; i < views.size(); ++i) {
+                if (views[i].isConstant()) {
+                    ops[i] = constants[i];
+                } else {
+                    ops[i] = load<T>(views[i].base->dtype(), views[i].base->getDataPtr(), offsets[i]);
+                }
+            }
+            store<T>(out_dtype, out_data, offsets[0], apply<T>(instr.opcode, ops[1], ops[2]));
+        });
+    }
+}
+
+// Execute `instr` by dispatching on its compute type
+void execute_instr(const bh_instruction &instr) {
+    switch (compute_type(instr)) {
+        case bh_type::BOOL:
+            return execute_instr<bool>(instr);
+        case bh_type::INT8:
+            return execute_instr<int8_t>(instr);
+        case bh_type::INT16:
+            return execute_instr<int16_t>(instr);
+        case bh_type::INT32:
+            return execute_instr<int32_t>(instr);
+        case bh_type::INT64:
+            return execute_instr<int64_t>(instr);
+        case bh_type::UINT8:
+            return execute_instr<uint8_t>(instr);
+        case bh_type::UINT16:
+            return execute_instr<uint16_t>(instr);
+        case bh_type::UINT32:
+            return execute_instr<uint32_t>(instr);
+        case bh_type::UINT64:
+            return execute_instr<uint64_t>(instr);
+        case bh_type::FLOAT32:
+            return execute_instr<float>(instr);
+        case bh_type::FLOAT64:
+            return execute_instr<double>(instr);
+        default:
+            throw runtime_error("interpreter: unsupported data type");
+    }
+}
+
+// Is `dtype` supported by the interpreter?
+bool supported(bh_type dtype) {
+    return not (bh_type_is_complex(dtype) or dtype == bh_type::R123);
+}
+
+// Is `instr` supported by the interpreter?
+bool supported(const bh_instruction &instr) {
+    if (bh_opcode_is_system(instr.opcode)) {
+        return true;
+    }
+    if (not (bh_opcode_is_sweep(instr.opcode) or supported_elementwise(instr.opcode) or instr.opcode == BH_RANGE
+             or instr.opcode == BH_GATHER or instr.opcode == BH_SCATTER or instr.opcode == BH_COND_SCATTER)) {
+        return false;
+    }
+    for (const bh_view &view: instr.operand) {
+        if (view.isConstant()) {
+            if (not supported(instr.constant.type)) {
+                return false;
+            }
+        } else if (not supported(view.base->dtype())) {
+            return false;
+        }
+    }
+    return true;
+}
+} // Anon namespace
+
+bool supported(const jitk::LoopB &kernel) {
+    for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(kernel)) {
+        if (not supported(*instr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void execute(const jitk::LoopB &kernel) {
+    for (const jitk::InstrPtr &instr: jitk::iterator::allInstr(kernel)) {
+        if (bh_opcode_is_system(instr->opcode)) {
+            continue;
+        }
+        // Temporary arrays only exist as arrays when interpreting
+        for (const bh_view &view: instr->getViews()) {
+            bh_data_malloc(view.base);
+        }
+        execute_instr(*instr);
+    }
+}
+
+} // interpreter
+} // bohrium
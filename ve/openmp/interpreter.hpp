@@ -0,0 +1,40 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <bohrium/jitk/block.hpp>
+
+namespace bohrium {
+namespace interpreter {
+
+/* A generic, pre-compiled executor of kernels. Instead of compiling a kernel, the interpreter executes the
+ * instructions of the kernel one at a time using strided loops. It is much slower than a compiled kernel,
+ * but it is used when a kernel must execute before its compilation has finished.
+ */
+
+// Returns true when all instructions in `kernel` are supported by the interpreter
+bool supported(const jitk::LoopB &kernel);
+
+// Execute the instructions in `kernel` one by one.
+// NB: the temporary arrays of `kernel` are allocated here but, like any other array, freed by the caller
+void execute(const jitk::LoopB &kernel);
+
+} // interpreter
+} // bohrium
@@ -90,6 +90,8 @@ public:
         if (not copy2host) {
             throw runtime_error("OpenMP - getMemoryPointer(): `copy2host` is not True");
         }
+        // The host might access the array thus deferred writes must be executed first
+        engine.flushLookahead();
         if (force_alloc) {
             bh_data_malloc(&base);
         }
@@ -105,6 +107,7 @@ public:
         if (not host_ptr) {
             throw runtime_error("OpenMP - setMemoryPointer(): `host_ptr` is not True");
         }
+        engine.flushLookahead();
         if (base->getDataPtr() != nullptr) {
             throw runtime_error("OpenMP - setMemoryPointer(): `base->getDataPtr()` is not NULL");
         }
@@ -123,6 +126,7 @@ public:
     string userKernel(const std::string &kernel, std::vector<bh_view> &operand_list,
                       const std::string &compile_cmd, const std::string &tag, const std::string &param) override {
         if (tag == "openmp") {
+            engine.flushLookahead();
             const auto texecution = chrono::steady_clock::now();
             string ret = engine.userKernel(kernel, operand_list, compile_cmd, tag, param);
             stat.time_total_execution += chrono::steady_clock::now() - texecution;
@@ -143,6 +147,8 @@ extern "C" void destroy(ComponentImpl *self) {
 }
 
 Impl::~Impl() {
+    // Instructions deferred by the lookahead must be executed before the engine is destroyed
+    engine.flushLookahead();
     if (stat.print_on_exit) {
         engine.updateFinalStatistics();
         stat.write("OpenMP", config.defaultGet<std::string>("prof_filename", ""), cout);
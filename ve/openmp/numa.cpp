@@ -0,0 +1,170 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <map>
+#include <boost/filesystem.hpp>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "numa.hpp"
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace bohrium {
+namespace numa {
+
+namespace {
+const fs::path sysfs_nodes("/sys/devices/system/node");
+
+// Parse a sysfs CPU list such as "0-3,8-11"
+vector<int> parse_cpulist(const string &cpulist) {
+    vector<int> ret;
+    stringstream ss(cpulist);
+    string range;
+    while (getline(ss, range, ',')) {
+        const size_t dash = range.find('-');
+        try {
+            const int first = stoi(range.substr(0, dash));
+            const int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                ret.push_back(cpu);
+            }
+        } catch (const std::logic_error &) {
+            // Ignore malformed ranges
+        }
+    }
+    return ret;
+}
+
+// Returns the IDs of the nodes in sysfs (key: node ID, value: its directory)
+map<int, fs::path> sysfs_node_dirs() {
+    map<int, fs::path> ret;
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(sysfs_nodes, ec), end; not ec and it != end; it.increment(ec)) {
+        const string name = it->path().filename().string();
+        if (name.size() > 4 and name.compare(0, 4, "node") == 0 and
+            name.find_first_not_of("0123456789", 4) == string::npos) {
+            ret[stoi(name.substr(4))] = it->path();
+        }
+    }
+    return ret;
+}
+}
+
+vector<vector<int> > node_cpus() {
+    vector<vector<int> > ret;
+    for (const auto &node: sysfs_node_dirs()) {
+        std::ifstream file((node.second / "cpulist").string());
+        string cpulist;
+        if (getline(file, cpulist)) {
+            vector<int> cpus = parse_cpulist(cpulist);
+            if (not cpus.empty()) {
+                ret.push_back(std::move(cpus));
+            }
+        }
+    }
+    if (ret.empty()) { // Without the topology, we have a single node of all CPUs
+        ret.emplace_back();
+        for (unsigned int cpu = 0; cpu < max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            ret.back().push_back(static_cast<int>(cpu));
+        }
+    }
+
+#ifdef __linux__
+    // Let's remove the CPUs that we are not allowed to run on
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (vector<int> &cpus: ret) {
+            cpus.erase(remove_if(cpus.begin(), cpus.end(), [&allowed](int cpu) {
+                return cpu >= CPU_SETSIZE or not CPU_ISSET(cpu, &allowed);
+            }), cpus.end());
+        }
+        ret.erase(remove_if(ret.begin(), ret.end(), [](const vector<int> &cpus) { return cpus.empty(); }),
+                  ret.end());
+    }
+#endif
+    return ret;
+}
+
+vector<int> pinning_order(const string &pinning) {
+    const vector<vector<int> > nodes = node_cpus();
+    vector<int> ret;
+    if (pinning == "compact") {
+        for (const vector<int> &cpus: nodes) {
+            ret.insert(ret.end(), cpus.begin(), cpus.end());
+        }
+    } else if (pinning == "scatter") {
+        size_t max_cpus = 0;
+        for (const vector<int> &cpus: nodes) {
+            max_cpus = max(max_cpus, cpus.size());
+        }
+        for (size_t i = 0; i < max_cpus; ++i) {
+            for (const vector<int> &cpus: nodes) {
+                if (i < cpus.size()) {
+                    ret.push_back(cpus[i]);
+                }
+            }
+        }
+    } else {
+        throw std::runtime_error("config: `numa_pinning` must be `none`, `compact`, or `scatter`");
+    }
+    return ret;
+}
+
+vector<unsigned long> node_mask() {
+    const map<int, fs::path> nodes = sysfs_node_dirs();
+    if (nodes.size() < 2) {
+        return {};
+    }
+    const int bits_per_word = 8 * sizeof(unsigned long);
+    vector<unsigned long> ret(nodes.rbegin()->first / bits_per_word + 1, 0);
+    for (const auto &node: nodes) {
+        ret[node.first / bits_per_word] |= 1ul << (node.first % bits_per_word);
+    }
+    return ret;
+}
+
+bool interleave(void *mem, uint64_t nbytes, const vector<unsigned long> &node_mask) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node_mask.empty()) {
+        return false;
+    }
+    const int bits_per_word = 8 * sizeof(unsigned long);
+    const int MPOL_INTERLEAVE_ = 3; // From <linux/mempolicy.h>
+    // NB: the kernel ignores the last bit of `maxnode` thus the plus one
+    return syscall(SYS_mbind, mem, nbytes, MPOL_INTERLEAVE_, node_mask.data(),
+                   node_mask.size() * bits_per_word + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+} // numa
+} // bohrium
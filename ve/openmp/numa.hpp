@@ -0,0 +1,49 @@
+/*
+This file is part of Bohrium and copyright (c) 2012 the Bohrium
+team <http://www.bh107.org>.
+
+Bohrium is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3
+of the License, or (at your option) any later version.
+
+Bohrium is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with Bohrium.
+
+If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bohrium {
+namespace numa {
+
+/* Helpers that query the NUMA topology of the machine and control page placement. They use the Linux sysfs
+ * and syscall interface directly thus no NUMA library is required. On other systems, the machine is seen as
+ * a single node.
+ */
+
+// Returns the CPUs of each NUMA node, which this process is allowed to run on
+std::vector<std::vector<int> > node_cpus();
+
+// Returns the CPUs in the order that threads should be pinned:
+//   `compact` fills one node before the next, `scatter` takes a CPU from each node in turn
+std::vector<int> pinning_order(const std::string &pinning);
+
+// Returns the mask of all NUMA nodes as used by `interleave()` or the empty mask when the machine has only one node
+std::vector<unsigned long> node_mask();
+
+// Interleave the pages of [mem, mem+nbytes) across the NUMA nodes of `node_mask` (see `node_mask()`).
+// Returns false when the mask is empty or the policy isn't supported.
+bool interleave(void *mem, uint64_t nbytes, const std::vector<unsigned long> &node_mask);
+
+} // numa
+} // bohrium